@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <time.h>
+#include "ledz.h"
+
+#define UNUSED_PARAM(var) do { (void)(var); } while (0)
+
+// amount of leds with pending work (blinking and internal PWM)
+#define BUSY_LEDS       8
+
+// amount of ticks per measurement
+#define TICKS           100000
+
+void gpio_set(int port, int pin, int value)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(value);
+}
+
+void gpio_pwm(int port, int pin, int duty)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(duty);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1E9 + ts.tv_nsec;
+}
+
+int main(void)
+{
+    const int pins[] = {0, 0};
+
+    for (int i = 0; i < BUSY_LEDS; i++)
+    {
+        ledz_t *led = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, pins);
+        ledz_blink(led, LEDZ_RED, 10 + i, 20 + i);
+        ledz_brightness(led, LEDZ_RED, 50);
+    }
+
+    printf("# idle_leds ns_per_tick\n");
+
+    int idle = 0;
+    for (int target = 0; target <= LEDZ_MAX_INSTANCES - BUSY_LEDS;
+         target = target ? target * 2 : 16)
+    {
+        // add static leds until the target is reached
+        for (; idle < target; idle++)
+        {
+            ledz_t *led = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_GREEN}, pins);
+            ledz_on(led, LEDZ_GREEN);
+        }
+
+        double start = now_ns();
+        for (int i = 0; i < TICKS; i++)
+            ledz_tick();
+        double elapsed = now_ns() - start;
+
+        printf("%d %.2f\n", idle, elapsed / TICKS);
+    }
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <time.h>
+#include "ledz.h"
+
+#define UNUSED_PARAM(var) do { (void)(var); } while (0)
+
+// simulated time per measurement
+#define SECONDS         10
+
+void gpio_set(int port, int pin, int value)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(value);
+}
+
+void gpio_pwm(int port, int pin, int duty)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(duty);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1E9 + ts.tv_nsec;
+}
+
+// tickless loop: sleep until the next event and advance the elapsed time
+static double run_tickless(unsigned int *events)
+{
+    uint64_t elapsed = 0;
+    *events = 0;
+
+    double start = now_ns();
+    while (elapsed < SECONDS * 1000000ULL)
+    {
+        uint32_t next = ledz_next_event_us();
+        ledz_advance(next);
+        elapsed += next;
+        (*events)++;
+    }
+
+    return now_ns() - start;
+}
+
+// periodic tick for the same time
+static double run_ticks(void)
+{
+    double start = now_ns();
+    for (uint32_t i = 0; i < SECONDS * (1000000 / LEDZ_TICK_PERIOD); i++)
+        ledz_tick();
+
+    return now_ns() - start;
+}
+
+int main(void)
+{
+    const int pins[] = {0, 0};
+
+    printf("# active events_per_s tickless_us_per_s ns_per_event tick_us_per_s\n");
+
+    int active = 0;
+    for (int target = 1; target <= LEDZ_MAX_INSTANCES; target *= 4)
+    {
+        // blinking leds with different periods, so their events don't happen together
+        for (; active < target; active++)
+        {
+            ledz_t *led = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, pins);
+            ledz_blink(led, LEDZ_RED, 100 + active % 397, 100 + active % 211);
+        }
+
+        unsigned int events;
+        double tickless = run_tickless(&events);
+        double ticks = run_ticks();
+
+        printf("%d %u %.1f %.1f %.1f\n", active, events / SECONDS, tickless / SECONDS / 1000,
+               tickless / events, ticks / SECONDS / 1000);
+    }
+
+    return 0;
+}
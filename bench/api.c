@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ledz.h"
+
+#define UNUSED_PARAM(var) do { (void)(var); } while (0)
+
+// tricolor leds, called in a shuffled order so the calls don't follow the memory layout
+#define LEDS            (LEDZ_MAX_INSTANCES / 3)
+
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS    200
+#endif
+
+static ledz_t *leds[LEDS];
+static unsigned int order[LEDS];
+
+void gpio_set(int port, int pin, int value)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(value);
+}
+
+void gpio_pwm(int port, int pin, int duty)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(duty);
+}
+
+static inline long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void set_red(ledz_t *led, int round)
+{
+    ledz_set(led, LEDZ_RED, round & 1);
+}
+
+static void set_all(ledz_t *led, int round)
+{
+    ledz_set(led, LEDZ_RED | LEDZ_GREEN | LEDZ_BLUE, round & 1);
+}
+
+static void blink_blue(ledz_t *led, int round)
+{
+    ledz_blink(led, LEDZ_BLUE, 100 + round, 200);
+}
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+static void brightness_blue(ledz_t *led, int round)
+{
+    ledz_brightness(led, LEDZ_BLUE, round % LEDZ_BRIGHTNESS_MAX);
+}
+
+static void fade_in_all(ledz_t *led, int round)
+{
+    ledz_fade_in(led, LEDZ_RED | LEDZ_GREEN | LEDZ_BLUE, 1 + round % 4, LEDZ_BRIGHTNESS_MAX);
+}
+#endif
+
+static ledz_t* create(int i)
+{
+    const ledz_color_t colors[] = {LEDZ_RED, LEDZ_GREEN, LEDZ_BLUE};
+    const int pins[] = {i, 0, i, 1, i, 2};
+
+    return ledz_create(LEDZ_3COLOR, colors, pins);
+}
+
+static void measure(const char *name, void (*function)(ledz_t *, int))
+{
+    long long elapsed = 0;
+
+    for (int round = 0; round < BENCH_ROUNDS; round++)
+    {
+        long long start = now_ns();
+        for (int i = 0; i < LEDS; i++)
+            function(leds[order[i]], round);
+        elapsed += now_ns() - start;
+
+#ifdef LEDZ_COMMAND_QUEUE
+        ledz_tick();
+#endif
+    }
+
+    printf("%s\t%d\t%d\t%.1f\n", name, LEDS, BENCH_ROUNDS, (double) elapsed / BENCH_ROUNDS / LEDS);
+}
+
+// destroy and create each led again, with all the other instances in use
+static void measure_churn(void)
+{
+    long long elapsed = 0;
+
+    for (int round = 0; round < BENCH_ROUNDS; round++)
+    {
+        long long start = now_ns();
+        for (int i = 0; i < LEDS; i++)
+        {
+            ledz_destroy(leds[order[i]]);
+            leds[order[i]] = create(order[i]);
+        }
+        elapsed += now_ns() - start;
+    }
+
+    printf("destroy+create\t%d\t%d\t%.1f\n", LEDS, BENCH_ROUNDS,
+           (double) elapsed / BENCH_ROUNDS / LEDS);
+}
+
+int main(void)
+{
+#ifdef LEDZ_ARENA_SUPPORT
+    static uint64_t arena[LEDZ_MAX_INSTANCES * 8];
+    if (ledz_init(arena, sizeof(arena)) < LEDZ_MAX_INSTANCES)
+    {
+        fprintf(stderr, "the arena is too small\n");
+        return 1;
+    }
+#endif
+
+    for (int i = 0; i < LEDS; i++)
+    {
+        leds[i] = create(i);
+        order[i] = i;
+    }
+
+    srand(1);
+    for (int i = LEDS - 1; i > 0; i--)
+    {
+        int j = rand() % (i + 1);
+        unsigned int swap = order[i];
+        order[i] = order[j];
+        order[j] = swap;
+    }
+
+    printf("call\tleds\trounds\tns_per_call\n");
+
+    measure("set red", set_red);
+    measure("set rgb", set_all);
+    measure("blink blue", blink_blue);
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+    measure("brightness blue", brightness_blue);
+    measure("fade_in rgb", fade_in_all);
+#endif
+    measure_churn();
+
+    return 0;
+}
@@ -0,0 +1,23 @@
+#!/bin/sh
+# compares two sweep results and lists the ns_per_tick regressions above a threshold
+# usage: compare.sh <baseline.tsv> <current.tsv> [threshold in percent, default 10]
+# the exit status is 1 when any regression is found
+
+if [ $# -lt 2 ]; then
+    echo "usage: $0 <baseline.tsv> <current.tsv> [threshold]" >&2
+    exit 2
+fi
+
+awk -F '\t' -v threshold=${3:-10} '
+    FNR == 1 { next }
+    { key = $1 "\t" $2 "\t" $3 }
+    NR == FNR { base[key] = $5; next }
+    key in base && base[key] > 0 {
+        delta = ($5 - base[key]) * 100 / base[key]
+        if (delta > threshold) {
+            printf "%s\t%.1f -> %.1f ns (+%.0f%%)\n", key, base[key], $5, delta
+            found = 1
+        }
+    }
+    END { exit found }
+' "$1" "$2"
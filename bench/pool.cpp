@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <time.h>
+#include "ledz.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES()        __rdtsc()
+#else
+#define CYCLES()        0ULL
+#endif
+
+// the same 16 leds driven by the C library and by the pool: 4 only on/off, 4 blinking,
+// 4 with brightness and 4 fading
+#define LEDS            16
+#define ROUNDS          200
+#define ROUND_TICKS     1000
+
+typedef ledz::Pool<ledz::Config,
+    ledz::Pin<0, 0, 0>, ledz::Pin<0, 1, 0>, ledz::Pin<0, 2, 0>, ledz::Pin<0, 3, 0>,
+    ledz::Pin<0, 4, ledz::BLINK>, ledz::Pin<0, 5, ledz::BLINK>,
+    ledz::Pin<0, 6, ledz::BLINK>, ledz::Pin<0, 7, ledz::BLINK>,
+    ledz::Pin<0, 8, ledz::BRIGHTNESS>, ledz::Pin<0, 9, ledz::BRIGHTNESS>,
+    ledz::Pin<0, 10, ledz::BRIGHTNESS>, ledz::Pin<0, 11, ledz::BRIGHTNESS>,
+    ledz::Pin<0, 12, ledz::BRIGHTNESS | ledz::FADE>,
+    ledz::Pin<0, 13, ledz::BRIGHTNESS | ledz::FADE>,
+    ledz::Pin<0, 14, ledz::BRIGHTNESS | ledz::FADE>,
+    ledz::Pin<0, 15, ledz::BRIGHTNESS | ledz::FADE>
+> pool_t;
+
+static pool_t pool;
+
+template <size_t I>
+static void pool_setup_led(void)
+{
+    if constexpr (I < 4)
+        pool.on<I>();
+    else if constexpr (I < 8)
+        pool.blink<I>(1 + I, 2 + I);
+    else if constexpr (I < 12)
+        pool.brightness<I>(I * 5);
+}
+
+template <size_t... I>
+static void pool_setup(std::index_sequence<I...>)
+{
+    (pool_setup_led<I>(), ...);
+}
+
+template <size_t... I>
+static void pool_fade_leds(int round, std::index_sequence<I...>)
+{
+    if (round % 2)
+        (pool.fade_out<12 + I>(1, 0), ...);
+    else
+        (pool.fade_in<12 + I>(1, 100), ...);
+}
+
+// only the pool functions are compiled, to compare the code size with ledz.o
+#ifdef POOL_SIZE
+extern "C" void pool_init(void)
+{
+    pool_setup(std::make_index_sequence<LEDS>{});
+}
+
+extern "C" void pool_fade(int round)
+{
+    pool_fade_leds(round, std::make_index_sequence<4>{});
+}
+
+extern "C" void pool_tick(void)
+{
+    pool.tick();
+}
+#else
+
+static volatile int sink;
+
+// not inlined in the pool either, the cost of the GPIO call is the same for both
+extern "C" __attribute__((noinline)) void gpio_set(int port, int pin, int value)
+{
+    sink = port + pin + value;
+}
+
+extern "C" __attribute__((noinline)) void gpio_pwm(int port, int pin, int duty)
+{
+    sink = port + pin + duty;
+}
+
+static inline long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static ledz_t *leds[LEDS];
+
+static void c_setup(void)
+{
+    const ledz_color_t colors[] = {LEDZ_RED};
+
+    for (int i = 0; i < LEDS; i++)
+    {
+        const int pins[] = {0, i};
+        leds[i] = ledz_create(LEDZ_1COLOR, colors, pins);
+
+        if (i < 4)
+            ledz_on(leds[i], LEDZ_RED);
+        else if (i < 8)
+            ledz_blink(leds[i], LEDZ_RED, 1 + i, 2 + i);
+        else if (i < 12)
+            ledz_brightness(leds[i], LEDZ_RED, i * 5);
+    }
+}
+
+static void c_fade(int round)
+{
+    for (int i = 12; i < LEDS; i++)
+    {
+        if (round % 2)
+            ledz_fade_out(leds[i], LEDZ_RED, 1, 0);
+        else
+            ledz_fade_in(leds[i], LEDZ_RED, 1, 100);
+    }
+}
+
+static void c_tick(void)
+{
+    ledz_tick();
+}
+
+static void pool_tick(void)
+{
+    pool.tick();
+}
+
+static void measure(const char *name, void (*fade)(int), void (*tick)(void))
+{
+    long long elapsed = 0;
+    unsigned long long cycles = 0;
+
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        fade(round);
+
+        long long start = now_ns();
+        unsigned long long start_cycles = CYCLES();
+        for (int i = 0; i < ROUND_TICKS; i++)
+            tick();
+        cycles += CYCLES() - start_cycles;
+        elapsed += now_ns() - start;
+    }
+
+    printf("%s\t%d\t%d\t%.1f\t%.1f\n", name, LEDS, ROUNDS * ROUND_TICKS,
+           (double) elapsed / (ROUNDS * ROUND_TICKS), (double) cycles / (ROUNDS * ROUND_TICKS));
+}
+
+static void pool_fade(int round)
+{
+    pool_fade_leds(round, std::make_index_sequence<4>{});
+}
+
+int main(void)
+{
+    c_setup();
+    pool_setup(std::make_index_sequence<LEDS>{});
+
+    printf("tick\tleds\tticks\tns_per_tick\tcycles_per_tick\n");
+
+    measure("c", c_fade, c_tick);
+    measure("pool", pool_fade, pool_tick);
+
+    return 0;
+}
+#endif
@@ -0,0 +1,35 @@
+#!/bin/sh
+# prints the RAM used per led instance for several configuration combinations
+# the size is read from the g_leds symbol of the library object file
+
+CC=${CC:-gcc}
+LIB_DIR=../src
+OBJ=$(mktemp)
+
+report()
+{
+    instances=$1
+    shift
+
+    if ! $CC -O2 -std=gnu99 -I$LIB_DIR -I../test -DLEDZ_MAX_INSTANCES=$instances "$@" \
+        -c $LIB_DIR/ledz.c -o $OBJ; then
+        echo "failed to build: $*" >&2
+        exit 1
+    fi
+
+    size=$(nm -S $OBJ | awk '$4 == "g_leds" { print $2 }')
+    printf "%-9s %-10s %-7s %s\n" $instances $((0x$size)) $((0x$size / instances)) "$*"
+}
+
+printf "%-9s %-10s %-7s %s\n" instances total per_led config
+for instances in 3 254 1024; do
+    report $instances
+    report $instances -DLEDZ_NO_BRIGHTNESS_SUPPORT
+    report $instances "-DLEDZ_GPIO_PWM(port,pin,duty)=gpio_pwm(port,pin,duty)"
+    report $instances -DLEDZ_BAM_SUPPORT
+    report $instances -DLEDZ_BAM_SUPPORT -DLEDZ_BAM_BITS=12
+    report $instances -DLEDZ_CURVE_SUPPORT
+    report $instances -DLEDZ_DEADLINE_HEAP
+done
+
+rm -f $OBJ
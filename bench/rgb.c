@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <time.h>
+#include "ledz.h"
+
+#define UNUSED_PARAM(var) do { (void)(var); } while (0)
+
+// tricolor leds and amount of frames measured per scenario
+#define LEDS            (LEDZ_MAX_INSTANCES / 3)
+
+#ifndef BENCH_FRAMES
+#define BENCH_FRAMES    2000
+#endif
+
+static ledz_t *leds[LEDS];
+static ledz_rgb_t rgb[LEDS];
+static ledz_hsv_t hsv[LEDS];
+
+void gpio_set(int port, int pin, int value)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(value);
+}
+
+void gpio_pwm(int port, int pin, int duty)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(duty);
+}
+
+static inline long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// colors changing every frame
+static void colors(int frame)
+{
+    for (int i = 0; i < LEDS; i++)
+    {
+        rgb[i] = (ledz_rgb_t){frame + i, frame * 3 + i, frame * 7 + i};
+        hsv[i] = (ledz_hsv_t){(frame + i) * 97, 255 - i % 64, 128 + frame % 128};
+    }
+}
+
+static void brightness(void)
+{
+    for (int i = 0; i < LEDS; i++)
+    {
+        ledz_brightness(leds[i], LEDZ_RED, rgb[i].red * LEDZ_BRIGHTNESS_MAX / 255);
+        ledz_brightness(leds[i], LEDZ_GREEN, rgb[i].green * LEDZ_BRIGHTNESS_MAX / 255);
+        ledz_brightness(leds[i], LEDZ_BLUE, rgb[i].blue * LEDZ_BRIGHTNESS_MAX / 255);
+    }
+}
+
+static void set_rgb(void)
+{
+    for (int i = 0; i < LEDS; i++)
+        ledz_set_rgb(leds[i], rgb[i].red, rgb[i].green, rgb[i].blue);
+}
+
+static void set_rgb_batch(void)
+{
+    ledz_set_rgb_batch(leds, rgb, LEDS);
+}
+
+static void set_hsv(void)
+{
+    for (int i = 0; i < LEDS; i++)
+        ledz_set_hsv(leds[i], hsv[i].hue, hsv[i].saturation, hsv[i].value);
+}
+
+static void set_hsv_batch(void)
+{
+    ledz_set_hsv_batch(leds, hsv, LEDS);
+}
+
+static void measure(const char *name, void (*function)(void))
+{
+    long long elapsed = 0;
+
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        colors(i);
+
+        long long start = now_ns();
+        function();
+        elapsed += now_ns() - start;
+    }
+
+    printf("%s\t%d\t%d\t%.1f\n", name, LEDS, BENCH_FRAMES, (double) elapsed / BENCH_FRAMES / LEDS);
+}
+
+int main(void)
+{
+    for (int i = 0; i < LEDS; i++)
+    {
+        leds[i] = ledz_create(LEDZ_3COLOR, (const ledz_color_t []){LEDZ_RED, LEDZ_GREEN, LEDZ_BLUE},
+                              (const int []){i, 0, i, 1, i, 2});
+    }
+
+    printf("function\tleds\tframes\tns_per_led\n");
+
+    measure("brightness x3", brightness);
+    measure("set_rgb", set_rgb);
+    measure("set_rgb_batch", set_rgb_batch);
+    measure("set_hsv", set_hsv);
+    measure("set_hsv_batch", set_hsv_batch);
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "ledz_shard.h"
+
+#define UNUSED_PARAM(var) do { (void)(var); } while (0)
+
+// the instances are split in one shard per context
+#define SHARDS          LEDZ_MAX_CONTEXTS
+#define INSTANCES       (LEDZ_MAX_INSTANCES / (SHARDS + 1))
+
+// amount of ticks measured per thread count
+#ifndef BENCH_TICKS
+#define BENCH_TICKS     20000
+#endif
+
+void gpio_set(int port, int pin, int value)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(value);
+}
+
+void gpio_pwm(int port, int pin, int duty)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(duty);
+}
+
+static inline long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void measure(unsigned int threads)
+{
+    if (ledz_shard_start(SHARDS, INSTANCES, threads, LEDZ_TICK_PERIOD, NULL))
+    {
+        printf("failed to start %u threads\n", threads);
+        return;
+    }
+
+    // all channels busy, blinking with the internal PWM
+    int channels = 0;
+    for (int i = 0; i < SHARDS; i++)
+    {
+        ledz_t *led;
+        while ((led = ledz_ctx_led_create(ledz_shard_ctx(i), LEDZ_1COLOR,
+                    (const ledz_color_t []){LEDZ_RED}, (const int []){i, channels % 32})))
+        {
+            ledz_blink(led, LEDZ_RED, 1 + channels % 7, 1 + channels % 5);
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+            ledz_brightness(led, LEDZ_RED, 1 + channels % (LEDZ_BRIGHTNESS_MAX - 1));
+#endif
+            channels++;
+
+#ifdef LEDZ_COMMAND_QUEUE
+            ledz_shard_tick();
+#endif
+        }
+    }
+
+    long long start = now_ns();
+    for (int i = 0; i < BENCH_TICKS; i++)
+        ledz_shard_tick();
+    long long elapsed = now_ns() - start;
+
+    ledz_shard_stop();
+
+    printf("%u\t%d\t%d\t%d\t%.1f\n", threads, SHARDS, channels, BENCH_TICKS,
+           (double) elapsed / BENCH_TICKS);
+}
+
+int main(int argc, char **argv)
+{
+    // maximum of threads, the amount of CPUs by default
+    long max = argc > 1 ? atol(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (max < 1)
+        max = 1;
+
+    printf("threads\tshards\tchannels\tticks\tns_per_tick\n");
+
+    // the shards can only be started once, so each measurement has its own process
+    for (long threads = 1; threads <= max; threads++)
+    {
+        fflush(stdout);
+
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            measure(threads);
+            fflush(stdout);
+            _exit(0);
+        }
+
+        waitpid(pid, NULL, 0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <time.h>
+#include "ledz_strip.h"
+
+// pixels of the strip and amount of frames measured per scenario
+#define PIXELS          1024
+
+#ifndef BENCH_FRAMES
+#define BENCH_FRAMES    2000
+#endif
+
+static uint8_t colors[LEDZ_STRIP_COLORS_SIZE(LEDZ_SK6812, PIXELS)];
+static uint8_t frame[LEDZ_STRIP_FRAME_SIZE(LEDZ_SK6812, PIXELS)];
+static uint32_t dirty[LEDZ_STRIP_DIRTY_SIZE(PIXELS)];
+
+static inline long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// changes one of each step pixels per frame and encodes them
+static void measure(ledz_strip_type_t type, const char *name, int step)
+{
+    ledz_strip_t strip;
+    ledz_strip_init(&strip, 0, type, PIXELS, colors, dirty, frame);
+
+    unsigned long long encoded = 0;
+    long long elapsed = 0;
+
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        for (int pixel = i % step; pixel < PIXELS; pixel += step)
+            ledz_strip_pwm(0, pixel * strip.channels, (i + pixel) % (LEDZ_PWM_MAX + 1));
+
+        long long start = now_ns();
+        encoded += ledz_strip_encode(&strip);
+        elapsed += now_ns() - start;
+    }
+
+    printf("%s\t%d\t%d\t%llu\t%.0f\n", name, PIXELS, 100 / step, encoded,
+           encoded * 1e9 / (elapsed ? elapsed : 1));
+}
+
+int main(void)
+{
+    static const struct {ledz_strip_type_t type; const char *name;} types[] = {
+        {LEDZ_WS2812, "ws2812"}, {LEDZ_SK6812, "sk6812"}, {LEDZ_APA102, "apa102"},
+    };
+
+    printf("type\tpixels\tdirty_pct\tencoded\tpixels_per_s\n");
+
+    for (unsigned int i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        measure(types[i].type, types[i].name, 1);
+        measure(types[i].type, types[i].name, 10);
+    }
+
+    return 0;
+}
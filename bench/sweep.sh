@@ -0,0 +1,35 @@
+#!/bin/sh
+# measures ledz_tick for each configuration combination and amount of instances
+# the results are printed as tab separated values, see tick.c for the columns
+
+CC=${CC:-gcc}
+LIB_DIR=../src
+BIN=$(mktemp)
+
+run()
+{
+    config=$1
+    instances=$2
+    shift 2
+
+    if ! $CC -O3 -std=gnu99 -I$LIB_DIR -I../test -DLEDZ_MAX_INSTANCES=$instances \
+        -DBENCH_CONFIG="\"$config\"" "$@" tick.c $LIB_DIR/ledz.c -o $BIN; then
+        echo "failed to build: $config $*" >&2
+        exit 1
+    fi
+
+    $BIN -
+}
+
+PWM="-DLEDZ_GPIO_PWM(port,pin,duty)=gpio_pwm(port,pin,duty)"
+
+printf "config\tinstances\tscenario\tticks\tns_per_tick\tworst_ns\n"
+for instances in 3 16 64 256 1024 4096; do
+    run brightness $instances
+    run brightness-gpio-pwm $instances "$PWM"
+    run brightness-stagger $instances -DLEDZ_PWM_STAGGER
+    run no-brightness $instances -DLEDZ_NO_BRIGHTNESS_SUPPORT
+    run no-brightness-gpio-pwm $instances -DLEDZ_NO_BRIGHTNESS_SUPPORT "$PWM"
+done
+
+rm -f $BIN
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <time.h>
+#include "ledz.h"
+
+#define UNUSED_PARAM(var) do { (void)(var); } while (0)
+
+// name of the configuration printed in the results (set by sweep.sh)
+#ifndef BENCH_CONFIG
+#define BENCH_CONFIG    "default"
+#endif
+
+// amount of ticks measured per scenario
+#ifndef BENCH_TICKS
+#define BENCH_TICKS     20000
+#endif
+
+// ticks of 50ms, the fades are restarted every chunk to never reach their limit
+#define CHUNK_TICKS     (50000 / LEDZ_TICK_PERIOD)
+
+enum {IDLE, BLINK, PWM, FADE};
+static const char *scenarios[] = {"idle", "blink", "pwm", "fade"};
+
+static ledz_t *leds[LEDZ_MAX_INSTANCES];
+
+void gpio_set(int port, int pin, int value)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(value);
+}
+
+void gpio_pwm(int port, int pin, int duty)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(duty);
+}
+
+static inline long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void setup(int scenario)
+{
+    for (int i = 0; i < LEDZ_MAX_INSTANCES; i++)
+    {
+        // static leds with a state, the previous scenario is cleared by ledz_set
+        ledz_set(leds[i], LEDZ_RED, i & 1);
+
+        switch (scenario)
+        {
+            case BLINK:
+                ledz_blink(leds[i], LEDZ_RED, 1 + i % 7, 1 + i % 5);
+                break;
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+            case PWM:
+                ledz_brightness(leds[i], LEDZ_RED, 1 + i % (LEDZ_BRIGHTNESS_MAX - 1));
+                break;
+
+            case FADE:
+                ledz_brightness(leds[i], LEDZ_RED, 0);
+                ledz_fade_in(leds[i], LEDZ_RED, 1, LEDZ_BRIGHTNESS_MAX);
+                break;
+#endif
+        }
+    }
+
+#ifdef LEDZ_COMMAND_QUEUE
+    // apply the queued commands out of the measurement
+    ledz_tick();
+#endif
+}
+
+static void measure(int scenario)
+{
+    long long total = 0, worst = 0;
+
+    setup(scenario);
+
+    for (int i = 0; i < BENCH_TICKS; i++)
+    {
+        if (scenario == FADE && i > 0 && i % CHUNK_TICKS == 0)
+            setup(scenario);
+
+        long long start = now_ns();
+        ledz_tick();
+        long long elapsed = now_ns() - start;
+
+        total += elapsed;
+        if (elapsed > worst)
+            worst = elapsed;
+    }
+
+    printf("%s\t%d\t%s\t%d\t%.1f\t%lld\n", BENCH_CONFIG, LEDZ_MAX_INSTANCES,
+           scenarios[scenario], BENCH_TICKS, (double) total / BENCH_TICKS, worst);
+}
+
+int main(int argc, char **argv)
+{
+    UNUSED_PARAM(argv);
+
+    const int pins[] = {0, 0};
+
+    for (int i = 0; i < LEDZ_MAX_INSTANCES; i++)
+        leds[i] = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, pins);
+
+    // the header is omitted when called with any argument, used to concatenate results
+    if (argc == 1)
+        printf("config\tinstances\tscenario\tticks\tns_per_tick\tworst_ns\n");
+
+    measure(IDLE);
+    measure(BLINK);
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+    measure(PWM);
+    measure(FADE);
+#endif
+
+    return 0;
+}
@@ -39,43 +39,210 @@
 */
 
 // calculate (rounded) how many ticks are need to reach a period of 1ms
-#define TICKS_TO_1ms        ((10000 / LEDZ_TICK_PERIOD + 5) / 10)
+#define TICKS_TO_1ms(period)    ((10000 / (period) + 5) / 10)
+
+// context of a led and tick period of a context, without the context support all leds
+// belong to the default context and the tick period is a constant
+#ifdef LEDZ_CONTEXT_SUPPORT
+#define MAX_CONTEXTS            (LEDZ_MAX_CONTEXTS + 1)
+#define LED_CTX(led)            (&g_contexts[(led)->ctx])
+#define CTX_TICK_PERIOD(ctx)    ((ctx)->tick_period)
+#define CTX_TICKS_TO_1ms(ctx)   ((ctx)->ticks_1ms)
+#else
+#define MAX_CONTEXTS            1
+#define LED_CTX(led)            (&g_contexts[0])
+#define CTX_TICK_PERIOD(ctx)    LEDZ_TICK_PERIOD
+#define CTX_TICKS_TO_1ms(ctx)   TICKS_TO_1ms(LEDZ_TICK_PERIOD)
+#endif
 
 // invert led value if user has defined LEDZ_TURN_ON_VALUE as zero
 #define LED_VALUE(val)      (!(LEDZ_TURN_ON_VALUE ^ (val)))
 
-// macro to set led GPIO
-#define LED_SET(led, val)   LEDZ_GPIO_SET(led->pins[0], led->pins[1], LED_VALUE(val)); \
-                            led->state = (val);
+// macros to access the GPIO of a led, the hooks of the led context replace the configured ones
+#ifdef LEDZ_CONTEXT_SUPPORT
+#define GPIO_PIN_SET(led, value)    ledz_gpio_set(led, value)
+#define GPIO_PIN_PWM(led, duty)     ledz_gpio_pwm(led, duty)
+#else
+#define GPIO_PIN_SET(led, value)    LEDZ_GPIO_SET(led->port, led->pin, value)
+#define GPIO_PIN_PWM(led, duty)     LEDZ_GPIO_PWM(led->port, led->pin, duty)
+#endif
+
+// the statistics count the GPIO and PWM writes of each led
+#ifdef LEDZ_STATS_SUPPORT
+#define GPIO_PIN(led, value)    (led->gpio_writes++, GPIO_PIN_SET(led, value))
+#define GPIO_PWM(led, duty)     (led->pwm_writes++, GPIO_PIN_PWM(led, duty))
+#else
+#define GPIO_PIN(led, value)    GPIO_PIN_SET(led, value)
+#define GPIO_PWM(led, duty)     GPIO_PIN_PWM(led, duty)
+#endif
+
+// in framed mode the GPIO changes made while applying a frame only mark the led as dirty,
+// the final state of the dirty leds is written at the end of the frame
+#ifdef LEDZ_FRAMED_MODE
+#define GPIO_OUT(led, value)    (LED_CTX(led)->framing ? ledz_frame_set(led) : \
+                                                         (void) GPIO_PIN(led, value))
+#define GPIO_DUTY(led, duty)    (LED_CTX(led)->framing ? ledz_frame_pwm(led, duty) : \
+                                                         (void) GPIO_PWM(led, duty))
+#else
+#define GPIO_OUT(led, value)    GPIO_PIN(led, value)
+#define GPIO_DUTY(led, duty)    GPIO_PWM(led, duty)
+#endif
+
+// macros to set led GPIO, from the API and from the tick (grouping the changes by port if
+// supported)
+#define GPIO_SET(led, val)      GPIO_OUT(led, LED_VALUE(val))
+#ifdef LEDZ_GPIO_WRITE_PORT
+#define GPIO_WRITE(led, val)    ledz_port_write(led, LED_VALUE(val))
+#else
+#define GPIO_WRITE(led, val)    GPIO_SET(led, val)
+#endif
+
+// macros to set led GPIO and state, a group has no GPIO and sets its members instead
+#ifdef LEDZ_GROUP_SUPPORT
+#define LED_SET(led, val)   do { led->master ? ledz_group_set(led, val, 0) : \
+                                               (void) GPIO_SET(led, val); \
+                                 led->state = (val); } while (0)
+#define LED_WRITE(led, val) do { led->master ? ledz_group_set(led, val, 1) : \
+                                               (void) GPIO_WRITE(led, val); \
+                                 led->state = (val); } while (0)
+#else
+#define LED_SET(led, val)   do { GPIO_SET(led, val); led->state = (val); } while (0)
+#define LED_WRITE(led, val) do { GPIO_WRITE(led, val); led->state = (val); } while (0)
+#endif
 
 // macro to set PWM
-#ifdef LEDZ_GPIO_PWM
-#define LED_PWM(led,duty)   LEDZ_GPIO_PWM(led->pins[0], led->pins[1], duty)
+#if defined(LEDZ_GPIO_PWM) && defined(LEDZ_GROUP_SUPPORT)
+#define LED_PWM(led,duty)   (led->master ? ledz_group_pwm(led, duty) : (void) GPIO_DUTY(led, duty))
+#elif defined(LEDZ_GPIO_PWM)
+#define LED_PWM(led,duty)   GPIO_DUTY(led, duty)
 #else
 #define LED_PWM(led,duty)
 #endif
 
 
+// alignment of the instances and contexts, so the contexts ticked by different cores
+// don't share cache lines
+#ifdef LEDZ_CACHE_LINE
+#define CACHE_ALIGNED       __attribute__((aligned(LEDZ_CACHE_LINE)))
+#else
+#define CACHE_ALIGNED
+#endif
+
+// alignment of the instances placed in the arena
+#ifdef LEDZ_CACHE_LINE
+#define ARENA_ALIGN         LEDZ_CACHE_LINE
+#else
+#define ARENA_ALIGN         __alignof__(ledz_t)
+#endif
+
+// amount of led instances
+#ifdef LEDZ_ARENA_SUPPORT
+#define LEDS_COUNT          g_leds_count
+#else
+#define LEDS_COUNT          LEDZ_MAX_INSTANCES
+#endif
+
+// conversion between led pointer and index
+#define INDEX_NONE          ((ledz_index_t) -1)
+#define LED_INDEX(led)      ((ledz_index_t) ((led) - g_leds))
+#define LED_PTR(index)      ((index) == INDEX_NONE ? 0 : &g_leds[index])
+
+// led at a position of the deadline heap of a context and order of two deadlines, which wrap
+// around with the tick counter
+#ifdef LEDZ_DEADLINE_HEAP
+#define HEAP_LED(ctx, pos)  (&g_leds[g_leds[(ctx)->first + (pos)].heap])
+#define HEAP_BEFORE(a, b)   ((int32_t) ((a)->deadline - (b)->deadline) < 0)
+#endif
+
+// the functions bring a led up to date before changing it, see ledz_sync
+#ifdef LEDZ_DEADLINE_HEAP
+#define LED_SYNC(led)       ledz_sync(led)
+#else
+#define LED_SYNC(led)       (led)
+#endif
+
+// duty cycle of the current led brightness
+#define LED_DUTY(led)       ledz_duty(led, led->brightness_value)
+
+// staggered internal PWM: the leds start the PWM with a phase according their index and
+// the edges over the limit of the tick are postponed, lengthening the current on or off
+// time (see LEDZ_PWM_STAGGER), the counters 0 and 1 both switch in the next tick so the
+// phase starts at 1
+#ifdef LEDZ_PWM_STAGGER
+#define PWM_PHASE(led)      (LED_INDEX(led) % LEDZ_PWM_MAX + 1)
+#define PWM_EDGE(led)       ledz_pwm_edge(led)
+#else
+#define PWM_PHASE(led)      0
+#define PWM_EDGE(led)       1
+#endif
+
+// dithered internal PWM: rounding error of the curve for the current led brightness and
+// reload of the counter, which is done by ledz_dither when the duty cycle has an error
+#ifdef LEDZ_DITHER_SUPPORT
+#define LED_RESIDUAL(led)   ledz_residual(led, led->brightness_value)
+#define PWM_DITHER(led)     ledz_dither(led)
+#else
+#define LED_RESIDUAL(led)   0
+#define PWM_DITHER(led)     0
+#endif
+
+// BAM period in ticks and conversion from duty cycle (0 to LEDZ_PWM_MAX) to BAM value
+#ifdef LEDZ_BAM_SUPPORT
+#define BAM_MAX             ((1 << LEDZ_BAM_BITS) - 1)
+#define BAM_DUTY(duty)      (((uint32_t) (duty) * BAM_MAX + LEDZ_PWM_MAX / 2) / LEDZ_PWM_MAX)
+#define LED_BAM(led)        led->pwm = BAM_DUTY(LED_DUTY(led))
+#else
+#define LED_BAM(led)
+#endif
+
+// scale of a RGB component (0 to 255) to brightness, in 16.16 fixed point, with a white balance
+#ifdef LEDZ_RGB_SUPPORT
+#define RGB_GAIN(balance)   ((uint32_t) (((uint64_t) (balance) * LEDZ_BRIGHTNESS_MAX << 16) / \
+                                         (255 * 255)))
+#endif
+
+// push and pop of the head of the active set, which is pushed by the functions and popped by the
+// tick, the latter retries on the next pass when a new head was pushed in between
+#define ACTIVE_CAS(ctx, head, next) __atomic_compare_exchange_n(&(ctx)->active, &(head), next, 0, \
+                                                                __ATOMIC_RELEASE, __ATOMIC_RELAXED)
+
+// atomic access to the command queue indexes
+#ifdef LEDZ_COMMAND_QUEUE
+#define QUEUE_LOAD(var, order)          __atomic_load_n(&(var), order)
+#define QUEUE_STORE(var, val, order)    __atomic_store_n(&(var), val, order)
+#define QUEUE_EMPTY(ctx)    (QUEUE_LOAD((ctx)->queue_head, __ATOMIC_RELAXED) == \
+                             QUEUE_LOAD((ctx)->queue_tail, __ATOMIC_ACQUIRE))
+#endif
+
+
 /*
 ****************************************************************************************************
 *       INTERNAL CONSTANTS
 ****************************************************************************************************
 */
 
-// table from: http://jared.geek.nz/2013/feb/linear-led-pwm
+// tables generated by tools/curves, the ones of the legacy resolution are committed and the
+// others are generated by the Makefile in its build directory
 #ifdef LEDZ_BRIGHTNESS_SUPPORT
-const unsigned char cie1931[101] = {
-      0,   0,   0,   0,   0,   1,   1,   1,   1,   1,
-      1,   1,   1,   2,   2,   2,   2,   2,   3,   3,
-      3,   3,   4,   4,   4,   4,   5,   5,   5,   6,
-      6,   7,   7,   8,   8,   8,   9,  10,  10,  11,
-     11,  12,  12,  13,  14,  15,  15,  16,  17,  18,
-     18,  19,  20,  21,  22,  23,  24,  25,  26,  27,
-     28,  29,  30,  32,  33,  34,  35,  37,  38,  39,
-     41,  42,  44,  45,  47,  48,  50,  52,  53,  55,
-     57,  58,  60,  62,  64,  66,  68,  70,  72,  74,
-     76,  78,  81,  83,  85,  88,  90,  92,  95,  97,
-    100,
+#ifdef LEDZ_BRIGHTNESS_BITS
+#include "ledz_curves_gen.h"
+#else
+#include "ledz_curves.h"
+#endif
+
+#if defined(LEDZ_BRIGHTNESS_BITS) ? LEDZ_CURVES_BITS != LEDZ_BRIGHTNESS_BITS : LEDZ_CURVES_BITS != 0
+#error "the curves do not match LEDZ_BRIGHTNESS_BITS, rebuild with LEDZ_BRIGHTNESS_BITS in CONFIG"
+#endif
+#endif
+
+#ifdef LEDZ_EASING_SUPPORT
+// (1 - cos(pi * t)) / 2 in 32 segments, interpolated by ledz_ease, scaled to 0xFFFF
+static const uint16_t ease_sine[33] = {
+    0, 158, 630, 1411, 2494, 3869, 5522, 7438,
+    9597, 11980, 14563, 17321, 20228, 23256, 26375, 29556,
+    32767, 35979, 39160, 42279, 45307, 48214, 50972, 53555,
+    55938, 58097, 60013, 61666, 63041, 64124, 64905, 65377,
+    65535,
 };
 #endif
 
@@ -86,28 +253,261 @@ const unsigned char cie1931[101] = {
 ****************************************************************************************************
 */
 
+// minimum width types according the configured ranges
+#if LEDZ_MAX_INSTANCES < 0xFF
+typedef uint8_t ledz_index_t;
+#else
+typedef uint16_t ledz_index_t;
+#endif
+
+#if LEDZ_BRIGHTNESS_MAX > 0xFF
+typedef uint16_t ledz_level_t;
+#else
+typedef uint8_t ledz_level_t;
+#endif
+
+#if LEDZ_PWM_MAX > 0xFF || (defined(LEDZ_BAM_SUPPORT) && LEDZ_BAM_BITS > 8)
+typedef uint16_t ledz_pwm_t;
+#else
+typedef uint8_t ledz_pwm_t;
+#endif
+
+// the fields are sorted by size to avoid padding
 struct LEDZ_T {
-    ledz_color_t color;
-    const int *pins;
+#ifdef LEDZ_STATS_SUPPORT
+    // GPIO and PWM writes counted by the statistics
+    uint32_t gpio_writes, pwm_writes;
+#endif
 
-    struct {
-        unsigned int state : 1;
-        unsigned int blink : 1;
-        unsigned int blink_state : 1;
-        unsigned int brightness : 1;
-    };
+#ifdef LEDZ_DEADLINE_HEAP
+    // tick of the next event of the led and tick which its counters were advanced to, the
+    // counters of a led in the deadline heap are only advanced when it is due or changed
+    uint32_t deadline, synced;
+#endif
 
     uint16_t time_on, time_off, time;
 
+    // 16 bits, so the pins of the channels of a long strip are kept (see ledz_strip.h)
+    uint16_t pin;
+
 #ifdef LEDZ_BRIGHTNESS_SUPPORT
-    unsigned int pwm, brightness_value;
-    unsigned int fade_in, fade_out;
-    unsigned int fade_min, fade_max, fade_counter;
+    uint16_t fade_in, fade_out, fade_counter;
+    ledz_level_t brightness_value, fade_min, fade_max;
+#endif
+
+#ifdef LEDZ_EASING_SUPPORT
+    // fade to a target: remaining time in ms, position in the fade (0 to 0xFFFF) and its step
+    // per ms
+    uint16_t ease_time, ease_phase, ease_step;
+    ledz_level_t ease_from, ease_to;
+#endif
+
+#if defined(LEDZ_BRIGHTNESS_SUPPORT) && !defined(LEDZ_GPIO_PWM)
+    // internal PWM counter or BAM value
+    ledz_pwm_t pwm;
+#endif
+
+    // index of the next led of the active set (leds with pending work in the tick)
+    ledz_index_t active_next;
+
+#ifdef LEDZ_DEADLINE_HEAP
+    // the deadline heap of a context is kept in its instances: heap is the led at the
+    // position of this instance in the heap and heap_pos the position of this led
+    ledz_index_t heap, heap_pos;
+#endif
+
+    // channel table of the object, only used by its first led: index of the other leds of
+    // the object and their colors, so the functions go straight to the leds of a color
+    ledz_index_t channel[LEDZ_3COLOR - 1];
+    uint8_t channel_color[LEDZ_3COLOR - 1];
+
+#ifdef LEDZ_ARENA_SUPPORT
+    // index of the next free instance
+    ledz_index_t free_next;
+#endif
+
+#ifdef LEDZ_GROUP_SUPPORT
+    // index of the next member of a group, the group itself holds the first member
+    ledz_index_t group_next;
+#endif
+
+#ifdef LEDZ_FRAMED_MODE
+    // index of the next led changed by the frame being applied
+    ledz_index_t dirty_next;
+#ifdef LEDZ_GPIO_PWM
+    ledz_duty_t frame_duty;
+#endif
+#endif
+
+#ifdef LEDZ_DITHER_SUPPORT
+    // rounding error of the duty cycle accumulated across the PWM periods
+    uint8_t dither;
+#endif
+
+#if defined(LEDZ_ARENA_SUPPORT) || defined(LEDZ_COMMAND_QUEUE)
+    // incremented when the instance is freed, checked by the handles and the queued commands
+    uint8_t generation;
+#endif
+
+    uint8_t color;
+    uint8_t port;
+
+    // in the active set, a byte of its own because it is cleared by the tick while the API
+    // might be writing the flags below, a read-modify-write of a shared byte would restore it
+    uint8_t active;
+
+    struct {
+        uint8_t used : 1;
+        uint8_t state : 1;
+        uint8_t blink : 1;
+        uint8_t blink_state : 1;
+        uint8_t brightness : 1;
+        uint8_t curve : 2;
+#ifdef LEDZ_DITHER_SUPPORT
+        // the accumulated error added one tick to the current PWM period
+        uint8_t dither_carry : 1;
 #endif
+#ifdef LEDZ_GROUP_SUPPORT
+        uint8_t master : 1;
+        uint8_t member : 1;
+#endif
+#ifdef LEDZ_EASING_SUPPORT
+        uint8_t easing : 3;
+#endif
+#ifdef LEDZ_FRAMED_MODE
+        // changed by the frame, GPIO state before the frame and PWM changed by the frame
+        uint8_t dirty : 1;
+        uint8_t frame_state : 1;
+        uint8_t frame_pwm : 1;
+#endif
+    };
 
-    ledz_t *next;
+#ifdef LEDZ_CONTEXT_SUPPORT
+    // index of the context which owns the led
+    uint8_t ctx;
+#endif
 };
 
+#ifdef LEDZ_PLAYER_SUPPORT
+// keyframe sequence being played by a led, the slot is free when seq is null
+typedef struct LEDZ_PLAYER_T {
+    const ledz_keyframe_t *seq;
+    uint16_t count, index;
+    uint16_t repeat, time;
+    ledz_index_t led;
+} ledz_player_t;
+#endif
+
+#ifdef LEDZ_COMMAND_QUEUE
+enum {CMD_SET, CMD_TOGGLE, CMD_BLINK, CMD_BRIGHTNESS, CMD_CURVE, CMD_FADE_IN, CMD_FADE_OUT,
+      CMD_FADE_TO, CMD_RGB, CMD_PLAY};
+
+typedef struct LEDZ_CMD_T {
+#ifdef LEDZ_PLAYER_SUPPORT
+    const ledz_keyframe_t *seq;
+#endif
+    uint16_t arg1, arg2;
+#ifdef LEDZ_RGB_SUPPORT
+    uint16_t arg3;
+#endif
+    ledz_index_t led;
+    uint8_t op, color, generation;
+#ifdef LEDZ_EASING_SUPPORT
+    uint8_t easing;
+#endif
+} ledz_cmd_t;
+#endif
+
+#ifdef LEDZ_GPIO_WRITE_PORT
+typedef struct LEDZ_PORT_T {
+    int port;
+    uint32_t mask, values;
+} ledz_port_t;
+#endif
+
+// everything changed by the tick, so each context can be ticked by its own timer
+struct LEDZ_CTX_T {
+    // range of instances owned by the context and how many of them are free
+    unsigned int first, size, available;
+
+#ifdef LEDZ_ARENA_SUPPORT
+    // instances never used, taken from the start of the range, and the first free instance
+    unsigned int fresh;
+    ledz_index_t free;
+#endif
+
+    // elapsed time not yet converted to ticks by ledz_advance
+    uint32_t elapsed_us;
+
+    // tick counter used to generate the 1ms flag
+    uint16_t counter_1ms;
+
+#ifdef LEDZ_CONTEXT_SUPPORT
+    uint16_t tick_period, ticks_1ms;
+    ledz_gpio_t gpio;
+#endif
+
+    // first led of the active set
+    ledz_index_t active;
+
+#ifdef LEDZ_DEADLINE_HEAP
+    // ticks run so far and the leds with pending work sorted by deadline, used by the
+    // tickless functions while the active set only holds the leds changed since the last
+    // event; ticking is set while the tick applies its commands, before the tick itself
+    uint32_t now;
+    unsigned int heap_count;
+    uint8_t heap_on, ticking;
+#endif
+
+#ifdef LEDZ_PWM_STAGGER
+    // edges written by the internal PWM in the current tick
+    uint16_t pwm_edges;
+#endif
+
+#ifdef LEDZ_STATS_SUPPORT
+    // statistics of the tick, the average is computed from the total cycles when read
+    ledz_stats_t stats;
+    uint64_t stats_cycles;
+#endif
+
+#ifdef LEDZ_BAM_SUPPORT
+    // tick position inside of the BAM period, current bit plane and plane boundary flag
+    uint16_t bam_counter;
+    uint8_t bam_plane, bam_boundary;
+#endif
+
+#ifdef LEDZ_PLAYER_SUPPORT
+    ledz_player_t players[LEDZ_MAX_PLAYERS];
+#endif
+
+#ifdef LEDZ_COMMAND_QUEUE
+    // commands written by the API (producer) and applied by the tick (consumer)
+    ledz_cmd_t queue[LEDZ_QUEUE_SIZE];
+    unsigned int queue_head, queue_tail;
+
+    // commands dropped because the queue was full, only written by the producer
+    unsigned int queue_dropped;
+#endif
+
+#ifdef LEDZ_FRAMED_MODE
+    // end of the commands of the frame being written, published by the commit
+    unsigned int queue_staged;
+
+    // the frame being written didn't fit in the queue and a part was published before the commit
+    uint8_t frame_split;
+
+    // leds changed while applying a frame
+    ledz_index_t dirty;
+    uint8_t framing;
+#endif
+
+#ifdef LEDZ_GPIO_WRITE_PORT
+    // GPIO changes of the current tick grouped by port
+    ledz_port_t ports[LEDZ_MAX_PORTS];
+    unsigned int ports_count;
+#endif
+} CACHE_ALIGNED;
+
 
 /*
 ****************************************************************************************************
@@ -115,8 +515,46 @@ struct LEDZ_T {
 ****************************************************************************************************
 */
 
-static ledz_t g_leds[LEDZ_MAX_INSTANCES];
-static unsigned int g_leds_available = LEDZ_MAX_INSTANCES;
+#ifdef LEDZ_ARENA_SUPPORT
+// instances placed in the arena by ledz_init
+static ledz_t *g_leds;
+static unsigned int g_leds_count;
+#else
+static ledz_t g_leds[LEDZ_MAX_INSTANCES] CACHE_ALIGNED;
+#endif
+
+#if defined(LEDZ_RAM_BUDGET) && !defined(LEDZ_ARENA_SUPPORT)
+_Static_assert(sizeof(g_leds) <= LEDZ_RAM_BUDGET, "ledz instances exceed LEDZ_RAM_BUDGET");
+#endif
+
+// the first context is the default one, used by ledz_create and ledz_tick
+static ledz_ctx_t g_contexts[MAX_CONTEXTS] = {
+    {
+#ifdef LEDZ_ARENA_SUPPORT
+        .free = INDEX_NONE,
+#else
+        .size = LEDZ_MAX_INSTANCES,
+        .available = LEDZ_MAX_INSTANCES,
+#endif
+        .active = INDEX_NONE,
+#ifdef LEDZ_FRAMED_MODE
+        .dirty = INDEX_NONE,
+#endif
+#ifdef LEDZ_CONTEXT_SUPPORT
+        .tick_period = LEDZ_TICK_PERIOD,
+        .ticks_1ms = TICKS_TO_1ms(LEDZ_TICK_PERIOD),
+#endif
+    },
+};
+
+#ifdef LEDZ_CONTEXT_SUPPORT
+static unsigned int g_contexts_count = 1;
+#endif
+
+#ifdef LEDZ_RGB_SUPPORT
+// red, green and blue gains set by ledz_rgb_balance
+static uint32_t g_rgb_gain[3] = {RGB_GAIN(255), RGB_GAIN(255), RGB_GAIN(255)};
+#endif
 
 
 /*
@@ -125,334 +563,2476 @@ static unsigned int g_leds_available = LEDZ_MAX_INSTANCES;
 ****************************************************************************************************
 */
 
-static inline ledz_t* ledz_take(void)
+#ifdef LEDZ_CONTEXT_SUPPORT
+static inline void ledz_gpio_set(ledz_t *led, int value)
 {
-    static unsigned int ledz_counter;
+    ledz_ctx_t *ctx = LED_CTX(led);
 
-    // first request round
-    if (ledz_counter < LEDZ_MAX_INSTANCES)
-    {
-        g_leds_available--;
-        ledz_t *led = &g_leds[ledz_counter++];
-        return led;
-    }
+    if (ctx->gpio.set)
+        ctx->gpio.set(led->port, led->pin, value);
+    else
+        LEDZ_GPIO_SET(led->port, led->pin, value);
+}
+
+#ifdef LEDZ_GPIO_PWM
+static inline void ledz_gpio_pwm(ledz_t *led, unsigned int duty)
+{
+    ledz_ctx_t *ctx = LED_CTX(led);
+
+    if (ctx->gpio.pwm)
+        ctx->gpio.pwm(led->port, led->pin, duty);
+    else
+        LEDZ_GPIO_PWM(led->port, led->pin, duty);
+}
+#endif
+#endif
 
-    // iterate all array searching for a free spot
-    // a led is considered free when pins is null
-    for (int i = 0; i < LEDZ_MAX_INSTANCES; i++)
+#ifdef LEDZ_ARENA_SUPPORT
+static inline void ledz_free_push(ledz_ctx_t *ctx, ledz_t *led)
+{
+    led->free_next = ctx->free;
+    ctx->free = LED_INDEX(led);
+}
+
+static inline ledz_t* ledz_take(ledz_ctx_t *ctx)
+{
+    // the last destroyed instance or the never used ones
+    ledz_t *led = LED_PTR(ctx->free);
+
+    if (led)
+        ctx->free = led->free_next;
+    else if (ctx->fresh < ctx->size)
+        led = &g_leds[ctx->first + ctx->fresh++];
+
+    if (led)
+        ctx->available--;
+
+    return led;
+}
+#else
+static inline ledz_t* ledz_take(ledz_ctx_t *ctx, unsigned int from)
+{
+    // iterate the instances of the context searching for a free spot, the instances before
+    // from are known to be in use
+    for (unsigned int i = from; i < ctx->first + ctx->size; i++)
     {
-        ledz_t *led  = &g_leds[i];
+        ledz_t *led = &g_leds[i];
 
-        if (led->pins == 0)
+        if (!led->used)
         {
-            g_leds_available--;
+            ctx->available--;
             return led;
         }
     }
 
     return 0;
 }
+#endif
 
-static inline void ledz_give(ledz_t *led)
+// advance the led counters by the given amount of ticks which must be less than the
+// amount returned by ledz_ticks_to_event, so no state change happens in the period
+static void ledz_skip(ledz_t *led, uint32_t ticks, uint32_t flags)
 {
-    if (led)
+    if (led->blink && led->time > 0)
+        led->time -= flags;
+
+#if defined(LEDZ_BRIGHTNESS_SUPPORT) && !defined(LEDZ_GPIO_PWM) && !defined(LEDZ_BAM_SUPPORT)
+    if (led->brightness && (!led->blink || led->blink_state) && led->pwm > 0)
+        led->pwm -= ticks;
+#else
+    (void) ticks;
+#endif
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+    if (flags > 0)
     {
-        led->pins = 0;
-        g_leds_available++;
+        if (led->fade_in > 0 && led->brightness_value < led->fade_max)
+            led->fade_counter += flags;
+        else
+            led->fade_in = 0;
+
+        if (led->fade_out > 0 && led->brightness_value > led->fade_min)
+            led->fade_counter += flags;
+        else
+            led->fade_out = 0;
     }
+#endif
 }
 
+static inline void ledz_active_push(ledz_ctx_t *ctx, ledz_t *led)
+{
+    ledz_index_t head = __atomic_load_n(&ctx->active, __ATOMIC_RELAXED);
 
-/*
-****************************************************************************************************
-*       GLOBAL FUNCTIONS
-****************************************************************************************************
-*/
+    do
+    {
+        led->active_next = head;
+    } while (!ACTIVE_CAS(ctx, head, LED_INDEX(led)));
+}
 
-ledz_t* ledz_create(ledz_type_t type, const ledz_color_t *colors, const int *pins)
+#ifdef LEDZ_DEADLINE_HEAP
+// 1ms flags in the ticks after the tick from up to the tick to, which is not after the
+// current tick, computed from the phase of the 1ms counter in the tick to
+static uint32_t ledz_flags_between(ledz_ctx_t *ctx, uint32_t from, uint32_t to)
 {
-    if (g_leds_available < type)
-        return 0;
+    uint32_t ticks_1ms = CTX_TICKS_TO_1ms(ctx);
+    uint32_t phase = (ctx->counter_1ms + ticks_1ms - (ctx->now - to) % ticks_1ms) % ticks_1ms;
+    uint32_t ticks = to - from;
 
-    ledz_t *next = 0;
+    return ticks > phase ? (ticks - phase - 1) / ticks_1ms + 1 : 0;
+}
+
+static inline void ledz_heap_place(ledz_ctx_t *ctx, ledz_t *led, unsigned int pos)
+{
+    g_leds[ctx->first + pos].heap = LED_INDEX(led);
+    led->heap_pos = pos;
+}
 
-    for (int i = type - 1; i >= 0; i--)
+static void ledz_heap_up(ledz_ctx_t *ctx, ledz_t *led, unsigned int pos)
+{
+    while (pos > 0)
     {
-        ledz_t *led = ledz_take();
-        led->color = colors[i];
-        led->pins = &pins[i * 2];
-        led->state = 0;
-        led->blink = 0;
-        led->next = next;
-        next = led;
+        ledz_t *parent = HEAP_LED(ctx, (pos - 1) / 2);
+        if (!HEAP_BEFORE(led, parent))
+            break;
+
+        ledz_heap_place(ctx, parent, pos);
+        pos = (pos - 1) / 2;
     }
 
-    return next;
+    ledz_heap_place(ctx, led, pos);
 }
 
-void ledz_destroy(ledz_t* led)
+static void ledz_heap_down(ledz_ctx_t *ctx, ledz_t *led, unsigned int pos)
 {
-    if (led->next)
-        ledz_destroy(led->next);
+    for (unsigned int child; (child = 2 * pos + 1) < ctx->heap_count; pos = child)
+    {
+        ledz_t *first = HEAP_LED(ctx, child);
+        if (child + 1 < ctx->heap_count && HEAP_BEFORE(HEAP_LED(ctx, child + 1), first))
+            first = HEAP_LED(ctx, ++child);
+
+        if (!HEAP_BEFORE(first, led))
+            break;
 
-    ledz_give(led);
+        ledz_heap_place(ctx, first, pos);
+    }
+
+    ledz_heap_place(ctx, led, pos);
 }
 
-void ledz_on(ledz_t* led, ledz_color_t color)
+// the position of a removed led is left behind, so the led is in the heap only when the
+// instance in its position still points to it
+static inline int ledz_heap_has(ledz_ctx_t *ctx, ledz_t *led)
 {
-    ledz_set(led, color, 1);
+    return led->heap_pos < ctx->heap_count && HEAP_LED(ctx, led->heap_pos) == led;
 }
 
-void ledz_off(ledz_t* led, ledz_color_t color)
+static void ledz_heap_remove(ledz_ctx_t *ctx, ledz_t *led)
 {
-    ledz_set(led, color, 0);
+    unsigned int pos = led->heap_pos;
+    ledz_t *last = HEAP_LED(ctx, --ctx->heap_count);
+
+    // the last led takes the position and moves up or down according its deadline
+    if (last == led)
+        return;
+
+    if (pos > 0 && HEAP_BEFORE(last, HEAP_LED(ctx, (pos - 1) / 2)))
+        ledz_heap_up(ctx, last, pos);
+    else
+        ledz_heap_down(ctx, last, pos);
 }
 
-void ledz_toggle(ledz_t* led, ledz_color_t color)
+// advance the counters of a led of the heap up to the given tick, which is before its deadline
+static inline void ledz_heap_skip(ledz_ctx_t *ctx, ledz_t *led, uint32_t to)
 {
-    ledz_set(led, color, -1);
+    if (to != led->synced)
+        ledz_skip(led, to - led->synced, ledz_flags_between(ctx, led->synced, to));
 }
 
-void ledz_set(ledz_t* led, ledz_color_t color, int value)
+// called before a function changes the led: the counters of the led are brought to the
+// current tick (or to the tick before while the tick applies its commands) and the led is
+// moved from the heap to the active set, so its deadline is computed again after the change
+static ledz_t* ledz_sync(ledz_t *led)
 {
-    // disable blinking and brightness control
-    led->blink = 0;
-    led->brightness = 0;
+    ledz_ctx_t *ctx = LED_CTX(led);
 
-    // adjust value
-    if (value >= 1)
-        value = 1;
+    if (!ctx->heap_on)
+        return led;
 
-    for (int i = 0; led; led = led->next, i++)
+    if (ledz_heap_has(ctx, led))
     {
-        if (led->color & color)
-        {
-            // skip update if value match current state
-            if (led->state == value)
-                continue;
+        ledz_heap_skip(ctx, led, ctx->now - ctx->ticking);
+        ledz_heap_remove(ctx, led);
+    }
+    else if (led->active)
+    {
+        // already in the active set
+        return led;
+    }
 
-            // toggle led if value is negative
-            if (value < 0)
-                value = 1 - led->state;
+    led->active = 1;
+    ledz_active_push(ctx, led);
 
-            // update led GPIO
-            LED_SET(led, value);
-        }
-    }
+    return led;
 }
+#endif
 
-void ledz_blink(ledz_t* led, ledz_color_t color, uint16_t time_on, uint16_t time_off)
+// led of the object in the slot of its channel table, the first slot is the object itself
+static inline ledz_t* ledz_slot(ledz_t *obj, unsigned int slot)
+{
+    if (slot == 0)
+        return obj;
+
+    return slot < LEDZ_3COLOR ? LED_PTR(obj->channel[slot - 1]) : 0;
+}
+
+// next led of the object with any of the colors, starting from the slot, which is moved past
+// the returned led. The colors are read from the channel table, so the leds of other colors
+// are not visited
+static inline ledz_t* ledz_channel(ledz_t *obj, unsigned int color, unsigned int *slot)
 {
-    if (time_on == 0 || time_off == 0)
+    if (*slot == 0)
     {
-        led->blink = 0;
-        return;
+        *slot = 1;
+        if (obj->color & color)
+            return LED_SYNC(obj);
     }
 
-    for (int i = 0; led; led = led->next, i++)
+    for (; *slot < LEDZ_3COLOR && obj->channel[*slot - 1] != INDEX_NONE; (*slot)++)
     {
-        if (led->color & color)
-        {
-            led->time_on = time_on;
-            led->time_off = time_off;
-
-            // load counter according current state
-            if (led->state)
-            {
-                led->blink_state = 1;
-                led->time = time_on;
-            }
-            else
-            {
-                led->blink_state = 0;
-                led->time = time_off;
-            }
-
-            // start blinking
-            led->blink = 1;
-        }
+        if (obj->channel_color[*slot - 1] & color)
+            return LED_SYNC(&g_leds[obj->channel[(*slot)++ - 1]]);
     }
+
+    return 0;
 }
 
-#ifdef LEDZ_BRIGHTNESS_SUPPORT
-void ledz_brightness(ledz_t* led, ledz_color_t color, unsigned int value)
+static inline void ledz_give(ledz_t *led)
 {
-    if (value >= 100)
-        value = 100;
-
-    for (int i = 0; led; led = led->next, i++)
+    if (led)
     {
-        if (led->color & color)
-        {
-            // convert brightness value to duty cycle according cie 1931
-            int duty_cycle = cie1931[value];
-
-            // enable hardware PWM
-            if (duty_cycle > 0 && duty_cycle < 100)
-                LED_PWM(led, duty_cycle);
+#ifdef LEDZ_DEADLINE_HEAP
+        ledz_sync(led);
+#endif
 
-            // does not use PWM if value is min or max
-            else
-                LED_SET(led, (duty_cycle >> 2) & 1);
+        // clear pending work so the tick drops the led from the active set
+        led->blink = 0;
+        led->brightness = 0;
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+        led->fade_in = 0;
+        led->fade_out = 0;
+#endif
+#ifdef LEDZ_EASING_SUPPORT
+        led->ease_time = 0;
+#endif
 
-            // enable brightness control
-            led->pwm = 0;
-            led->brightness_value = value;
-            led->brightness = 1;
-        }
+        led->used = 0;
+#if defined(LEDZ_ARENA_SUPPORT) || defined(LEDZ_COMMAND_QUEUE)
+        led->generation++;
+#endif
+        LED_CTX(led)->available++;
     }
 }
 
-void ledz_fade_in(ledz_t* led, ledz_color_t color, unsigned int rate, unsigned int max)
+#ifdef LEDZ_GPIO_WRITE_PORT
+static inline void ledz_port_write(ledz_t *led, int value)
 {
-    for (int i = 0; led; led = led->next, i++)
+    // the pins past the 32 bits of the mask are written directly
+    if (led->pin >= 32)
+    {
+        GPIO_PIN(led, value);
+        return;
+    }
+
+    ledz_ctx_t *ctx = LED_CTX(led);
+
+#ifdef LEDZ_CONTEXT_SUPPORT
+    // a context with its own set function and no port function writes its pins with the former
+    if (ctx->gpio.set && !ctx->gpio.write_port)
+    {
+        GPIO_PIN(led, value);
+        return;
+    }
+#endif
+
+    uint32_t bit = (uint32_t) 1 << led->pin;
+    ledz_port_t *port = 0;
+
+    // search the port in the current batch
+    for (unsigned int i = 0; i < ctx->ports_count; i++)
     {
-        if (led->color & color)
+        if (ctx->ports[i].port == led->port)
         {
-            led->fade_in = rate;
-            led->fade_max = max;
+            port = &ctx->ports[i];
+            break;
+        }
+    }
 
-            if (!led->brightness)
-            {
-                led->pwm = 0;
-                led->brightness_value = 0;
-                led->brightness = 1;
-            }
+    if (!port)
+    {
+        // no more room in the batch, write the pin directly
+        if (ctx->ports_count >= LEDZ_MAX_PORTS)
+        {
+            GPIO_PIN(led, value);
+            return;
         }
+
+        port = &ctx->ports[ctx->ports_count++];
+        port->port = led->port;
+        port->mask = 0;
+        port->values = 0;
     }
+
+#ifdef LEDZ_STATS_SUPPORT
+    led->gpio_writes++;
+#endif
+
+    port->mask |= bit;
+    if (value)
+        port->values |= bit;
+    else
+        port->values &= ~bit;
 }
 
-void ledz_fade_out(ledz_t* led, ledz_color_t color, unsigned int rate, unsigned int min)
+static inline void ledz_port_flush(ledz_ctx_t *ctx)
 {
-    for (int i = 0; led; led = led->next, i++)
+    for (unsigned int i = 0; i < ctx->ports_count; i++)
     {
-        if (led->color & color)
+        ledz_port_t *port = &ctx->ports[i];
+
+#ifdef LEDZ_CONTEXT_SUPPORT
+        if (ctx->gpio.write_port)
         {
-            led->fade_out = rate;
-            led->fade_min = min;
+            ctx->gpio.write_port(port->port, port->mask, port->values);
+            continue;
         }
+#endif
+
+        LEDZ_GPIO_WRITE_PORT(port->port, port->mask, port->values);
     }
+
+    ctx->ports_count = 0;
 }
 #endif
 
-void ledz_tick(void)
+#ifdef LEDZ_FRAMED_MODE
+static void ledz_frame_mark(ledz_t *led)
 {
-    static uint16_t counter_1ms;
-    int flag_1ms = 0;
-
-    // check if 1ms has been passed
-    if (++counter_1ms >= TICKS_TO_1ms)
+    if (!led->dirty)
     {
-        counter_1ms = 0;
-        flag_1ms = 1;
+        ledz_ctx_t *ctx = LED_CTX(led);
+
+        // the state is updated after the GPIO, so it still holds the value before the frame
+        led->dirty = 1;
+        led->frame_state = led->state;
+        led->frame_pwm = 0;
+        led->dirty_next = ctx->dirty;
+        ctx->dirty = LED_INDEX(led);
     }
+}
+
+static void ledz_frame_set(ledz_t *led)
+{
+    // the GPIO set replaces a PWM of the same frame
+    ledz_frame_mark(led);
+    led->frame_pwm = 0;
+}
+
+#ifdef LEDZ_GPIO_PWM
+static void ledz_frame_pwm(ledz_t *led, unsigned int duty)
+{
+    ledz_frame_mark(led);
+    led->frame_pwm = 1;
+    led->frame_duty = duty;
+}
+#endif
 
-    for (int i = 0; i < LEDZ_MAX_INSTANCES; i++)
+// write the final GPIO state of the leds changed by the frame
+static void ledz_frame_flush(ledz_ctx_t *ctx)
+{
+    while (ctx->dirty != INDEX_NONE)
     {
-        ledz_t *led = &g_leds[i];
+        ledz_t *led = &g_leds[ctx->dirty];
+        ctx->dirty = led->dirty_next;
+        led->dirty = 0;
 
-        // skip if led is not in use
-        if (led->pins == 0)
+#ifdef LEDZ_GPIO_PWM
+        // the last output of the frame is either the PWM or the GPIO
+        if (led->frame_pwm)
+        {
+            GPIO_PWM(led, led->frame_duty);
             continue;
+        }
+#endif
+
+        // skip the leds which are back to the state before the frame, unless the brightness
+        // control is enabled since the hardware PWM might be the current output
+        if (led->state != led->frame_state || led->brightness)
+            GPIO_WRITE(led, led->state);
+    }
+}
+#endif
+
+#ifdef LEDZ_GROUP_SUPPORT
+// set the members of a group, grouping the changes by port when called from the tick
+static void ledz_group_set(ledz_t *group, int value, int from_tick)
+{
+    for (ledz_t *led = LED_PTR(group->group_next); led; led = LED_PTR(led->group_next))
+    {
+        if (from_tick)
+            GPIO_WRITE(led, value);
+        else
+            GPIO_SET(led, value);
 
-        // execute blink control if 1ms has been passed
-        if (led->blink && flag_1ms)
+        led->state = value;
+    }
+
+#ifndef LEDZ_GPIO_WRITE_PORT
+    (void) from_tick;
+#endif
+}
+
+#ifdef LEDZ_GPIO_PWM
+static void ledz_group_pwm(ledz_t *group, unsigned int duty)
+{
+    for (ledz_t *led = LED_PTR(group->group_next); led; led = LED_PTR(led->group_next))
+        GPIO_DUTY(led, duty);
+}
+#endif
+
+static void ledz_group_unlink(ledz_t *group, ledz_t *member)
+{
+    for (ledz_index_t *link = &group->group_next; *link != INDEX_NONE;
+         link = &g_leds[*link].group_next)
+    {
+        if (*link == LED_INDEX(member))
         {
-            if (led->time > 0)
-                led->time--;
+            *link = member->group_next;
+            member->member = 0;
+            return;
+        }
+    }
+}
 
-            if (led->time == 0)
-            {
-                if (led->blink_state)
-                {
-                    // disable hardware PWM
-                    LED_PWM(led, 0);
+// remove the led from the group which it belongs to
+static void ledz_group_leave(ledz_t *member)
+{
+    for (unsigned int i = 0; member->member && i < LEDS_COUNT; i++)
+    {
+        if (g_leds[i].used && g_leds[i].master)
+            ledz_group_unlink(&g_leds[i], member);
+    }
+}
+#endif
 
-                    // turn off led
-                    LED_SET(led, 0);
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+static inline unsigned int ledz_duty(ledz_t *led, unsigned int value)
+{
+#ifdef LEDZ_CURVE_SUPPORT
+    if (led->curve == LEDZ_CURVE_GAMMA)
+        return gamma22[value];
 
-                    // load counter with time off value
-                    led->time = led->time_off;
-                }
-                else
-                {
-                    // turn on led
-                    LED_SET(led, 1);
+    // brightness and duty cycle have the same range
+    if (led->curve == LEDZ_CURVE_LINEAR)
+        return value;
+#else
+    (void) led;
+#endif
 
-                    // enable hardware PWM
-                    LED_PWM(led, cie1931[led->brightness_value]);
+    return cie1931[value];
+}
 
-                    // load counter with time on value
-                    led->time = led->time_on;
-                }
+#ifdef LEDZ_DITHER_SUPPORT
+// rounding error of ledz_duty in 1/256 of a step
+static inline int ledz_residual(ledz_t *led, unsigned int value)
+{
+#ifdef LEDZ_CURVE_SUPPORT
+    if (led->curve == LEDZ_CURVE_GAMMA)
+        return gamma22_residual[value];
 
-                // toggle blink state
-                led->blink_state = 1 - led->blink_state;
+    if (led->curve == LEDZ_CURVE_LINEAR)
+        return 0;
+#else
+    (void) led;
+#endif
 
-                // go to next led if blink control has updated led state
-                continue;
-            }
-        }
+    return cie1931_residual[value];
+}
+#endif
+#endif
+
+static inline int ledz_busy(ledz_t *led)
+{
+    if (led->blink)
+        return 1;
 
 #ifdef LEDZ_BRIGHTNESS_SUPPORT
+    if (led->fade_in || led->fade_out)
+        return 1;
+
+#ifdef LEDZ_EASING_SUPPORT
+    if (led->ease_time)
+        return 1;
+#endif
 
-        // PWM generation for brightness control
 #ifndef LEDZ_GPIO_PWM
-        if (led->brightness && (!led->blink || (led->blink && led->blink_state)))
+    // internal PWM generation
+    if (led->brightness)
+        return 1;
+#endif
+#endif
+
+    return 0;
+}
+
+static inline void ledz_activate(ledz_t *led)
+{
+    // the work flags must be set before calling this function, this way the tick
+    // never drops a led which has just received new work
+    if (!led->active)
+    {
+        led->active = 1;
+        ledz_active_push(LED_CTX(led), led);
+    }
+}
+
+#ifdef LEDZ_EASING_SUPPORT
+// easing curve at the position t of the fade, both from 0 to 0xFFFF
+static inline uint32_t ledz_ease(unsigned int easing, uint32_t t)
+{
+    switch (easing)
+    {
+        case LEDZ_EASE_IN:
+            return (t * t) >> 16;
+
+        case LEDZ_EASE_OUT:
+            return 0xFFFF - (((0xFFFF - t) * (0xFFFF - t)) >> 16);
+
+        case LEDZ_EASE_IN_OUT:
+        {
+            // t^2 * (3 - 2t), the second factor is shifted to fit 32 bits
+            uint32_t t2 = (t * t) >> 16;
+            return (t2 * ((3 * 0x10000 - 2 * t) >> 2)) >> 14;
+        }
+
+        case LEDZ_EASE_SINE:
         {
-            if (led->pwm > 0)
-                led->pwm--;
+            uint32_t i = t >> 11, frac = t & 0x7FF;
+            return ease_sine[i] + (((ease_sine[i + 1] - ease_sine[i]) * frac) >> 11);
+        }
+    }
 
-            if (led->pwm == 0)
-            {
-                // load counter with duty cycle according led state
-                if (led->state)
-                    led->pwm = 100 - cie1931[led->brightness_value];
-                else
-                    led->pwm = cie1931[led->brightness_value];
-
-                // change led state only if value is between min and max
-                if (led->pwm > 0 && led->pwm < 100)
-                    LED_SET(led, !led->state);
-            }
+    return t;
+}
+
+// advance the fade by 1ms, only additions, multiplications and shifts
+static void ledz_ease_update(ledz_t *led)
+{
+    unsigned int value = led->ease_to;
+
+    if (--led->ease_time > 0)
+    {
+        // the step is rounded down, the last ms sets the target
+        uint32_t phase = (uint32_t) led->ease_phase + led->ease_step;
+        led->ease_phase = phase > 0xFFFF ? 0xFFFF : phase;
+
+        uint32_t eased = ledz_ease(led->easing, led->ease_phase);
+        if (led->ease_to >= led->ease_from)
+            value = led->ease_from + (((uint32_t) (led->ease_to - led->ease_from) * eased) >> 16);
+        else
+            value = led->ease_from - (((uint32_t) (led->ease_from - led->ease_to) * eased) >> 16);
+    }
+
+    if (value != led->brightness_value)
+    {
+        led->brightness_value = value;
+        LED_PWM(led, LED_DUTY(led));
+        LED_BAM(led);
+    }
+}
+#endif
+
+#ifdef LEDZ_PWM_STAGGER
+// take one of the internal PWM edges of the tick, returns zero when the edge of the led
+// must be postponed to the next tick
+static inline int ledz_pwm_edge(ledz_t *led)
+{
+    ledz_ctx_t *ctx = LED_CTX(led);
+    unsigned int duty = LED_DUTY(led);
+
+    // the reload does not change the led at min or max
+    if ((led->state ? duty == LEDZ_PWM_MAX : duty == 0) && !LED_RESIDUAL(led))
+        return 1;
+
+    if (ctx->pwm_edges >= LEDZ_PWM_MAX_EDGES)
+        return 0;
+
+    ctx->pwm_edges++;
+    return 1;
+}
+#endif
+
+#ifdef LEDZ_DITHER_SUPPORT
+// duty cycle of the current PWM period: the whole ticks below the curve plus the carry
+static inline unsigned int ledz_dither_duty(ledz_t *led)
+{
+    return LED_DUTY(led) - (LED_RESIDUAL(led) < 0) + led->dither_carry;
+}
+
+// reloads the internal PWM counter when the duty cycle has a rounding error, returns zero
+// otherwise. Every period lasts LEDZ_PWM_MAX ticks, the led is kept on or off during the
+// whole period when the duty cycle of the period is max or zero
+static int ledz_dither(ledz_t *led)
+{
+    int residual = LED_RESIDUAL(led);
+    if (residual == 0)
+        return 0;
+
+    // off time of the current period
+    if (led->state)
+    {
+        unsigned int off = LEDZ_PWM_MAX - ledz_dither_duty(led);
+        if (off > 0)
+        {
+            led->pwm = off;
+            LED_WRITE(led, 0);
+            return 1;
         }
+    }
+
+    // new period, the error above the whole ticks is accumulated and its carry adds one tick
+    unsigned int sum = led->dither + (residual < 0 ? residual + 256 : residual);
+    led->dither = sum;
+    led->dither_carry = sum >> 8;
+
+    unsigned int on = ledz_dither_duty(led);
+    if (on > 0)
+    {
+        led->pwm = on;
+        if (!led->state)
+            LED_WRITE(led, 1);
+    }
+    else
+    {
+        led->pwm = LEDZ_PWM_MAX;
+        if (led->state)
+            LED_WRITE(led, 0);
+    }
+
+    return 1;
+}
 #endif
 
-        // fade control
-        if (flag_1ms)
+static void ledz_update(ledz_t *led, int flag_1ms)
+{
+    // execute blink control if 1ms has been passed
+    if (led->blink && flag_1ms)
+    {
+        if (led->time > 0)
+            led->time--;
+
+        if (led->time == 0)
         {
-            // fade in
-            if (led->fade_in > 0 && led->brightness_value < led->fade_max)
+            if (led->blink_state)
             {
-                if (++led->fade_counter == led->fade_in)
-                {
-                    led->brightness_value++;
-                    led->fade_counter = 0;
-                    LED_PWM(led, cie1931[led->brightness_value]);
-                }
+                // disable hardware PWM
+                LED_PWM(led, 0);
+
+                // turn off led
+                LED_WRITE(led, 0);
+
+                // load counter with time off value
+                led->time = led->time_off;
             }
             else
             {
-                // disable fade in
-                led->fade_in = 0;
+                // turn on led
+                LED_WRITE(led, 1);
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+                // enable hardware PWM
+                LED_PWM(led, LED_DUTY(led));
+#endif
+
+                // load counter with time on value
+                led->time = led->time_on;
             }
 
-            // fade out
-            if (led->fade_out > 0 && led->brightness_value > led->fade_min)
+            // toggle blink state
+            led->blink_state = 1 - led->blink_state;
+
+            // skip PWM and fade control if blink control has updated led state
+            return;
+        }
+    }
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+
+    // PWM generation for brightness control
+#if !defined(LEDZ_GPIO_PWM) && defined(LEDZ_BAM_SUPPORT)
+    if (led->brightness && (!led->blink || led->blink_state) && LED_CTX(led)->bam_boundary)
+    {
+        // output the bit of the current plane, pwm holds the BAM value
+        int bit = (led->pwm >> LED_CTX(led)->bam_plane) & 1;
+        if (bit != led->state)
+            LED_WRITE(led, bit);
+    }
+#elif !defined(LEDZ_GPIO_PWM)
+    if (led->brightness && (!led->blink || (led->blink && led->blink_state)))
+    {
+        if (led->pwm > 0)
+            led->pwm--;
+
+        // a postponed edge keeps the counter at zero, shifting the phase of the led
+        if (led->pwm == 0 && PWM_EDGE(led) && !PWM_DITHER(led))
+        {
+            // load counter with duty cycle according led state
+            if (led->state)
+                led->pwm = LEDZ_PWM_MAX - LED_DUTY(led);
+            else
+                led->pwm = LED_DUTY(led);
+
+            // change led state only if value is between min and max
+            if (led->pwm > 0 && led->pwm < LEDZ_PWM_MAX)
+                LED_WRITE(led, !led->state);
+
+            // the duty cycle reached min or max with the led in the opposite state
+            else if (led->pwm == LEDZ_PWM_MAX)
             {
-                if (++led->fade_counter == led->fade_out)
-                {
-                    led->brightness_value--;
-                    led->fade_counter = 0;
-                    LED_PWM(led, cie1931[led->brightness_value]);
-                }
+                LED_WRITE(led, !led->state);
+                led->pwm = 0;
             }
-            else
+        }
+    }
+#endif
+
+    // fade control
+    if (flag_1ms)
+    {
+        // fade in
+        if (led->fade_in > 0 && led->brightness_value < led->fade_max)
+        {
+            if (++led->fade_counter == led->fade_in)
+            {
+                led->brightness_value++;
+                led->fade_counter = 0;
+                LED_PWM(led, LED_DUTY(led));
+                LED_BAM(led);
+            }
+        }
+        else
+        {
+            // disable fade in
+            led->fade_in = 0;
+        }
+
+        // fade out
+        if (led->fade_out > 0 && led->brightness_value > led->fade_min)
+        {
+            if (++led->fade_counter == led->fade_out)
             {
-                // disable fade out
-                led->fade_out = 0;
+                led->brightness_value--;
+                led->fade_counter = 0;
+                LED_PWM(led, LED_DUTY(led));
+                LED_BAM(led);
             }
         }
+        else
+        {
+            // disable fade out
+            led->fade_out = 0;
+        }
+
+#ifdef LEDZ_EASING_SUPPORT
+        if (led->ease_time > 0)
+            ledz_ease_update(led);
+#endif
+    }
+#endif
+}
+
+// ticks until the next 1ms flag
+static inline uint32_t ledz_ticks_to_1ms(ledz_ctx_t *ctx)
+{
+    return CTX_TICKS_TO_1ms(ctx) - ctx->counter_1ms;
+}
+
+#ifdef LEDZ_BAM_SUPPORT
+// ticks until the next BAM plane boundary, planes start at the tick 2^n - 1 of the period
+static inline uint32_t ledz_ticks_to_bam_boundary(ledz_ctx_t *ctx)
+{
+    uint32_t start = 1;
+    while (start - 1 <= ctx->bam_counter)
+        start <<= 1;
+
+    return (start - 1) - ctx->bam_counter;
+}
+
+static void ledz_bam_advance(ledz_ctx_t *ctx, uint32_t ticks)
+{
+    ctx->bam_counter = (ctx->bam_counter + ticks % BAM_MAX) % BAM_MAX;
+    ctx->bam_boundary = (ctx->bam_counter & (ctx->bam_counter + 1)) == 0;
+
+    // the plane of a given tick position is log2(position + 1)
+    ctx->bam_plane = 0;
+    while (((uint32_t) 2 << ctx->bam_plane) - 1 <= ctx->bam_counter)
+        ctx->bam_plane++;
+}
+#endif
+
+// ticks until the given amount of 1ms flags, saturating at LEDZ_NO_EVENT
+static uint32_t ledz_flags_to_ticks(ledz_ctx_t *ctx, uint32_t flags)
+{
+    uint32_t max_flags = (LEDZ_NO_EVENT - ledz_ticks_to_1ms(ctx)) / CTX_TICKS_TO_1ms(ctx);
+
+    if (flags > max_flags)
+        return LEDZ_NO_EVENT;
+
+    return ledz_ticks_to_1ms(ctx) + (flags - 1) * CTX_TICKS_TO_1ms(ctx);
+}
+
+// ticks until the tick which will change the led state (LEDZ_NO_EVENT if none)
+static uint32_t ledz_ticks_to_event(ledz_t *led)
+{
+    uint32_t ticks = LEDZ_NO_EVENT, flags = 0;
+
+    if (led->blink)
+    {
+        // the blink toggles in the 1ms flag where time reaches zero
+        flags = led->time > 0 ? led->time : 1;
+    }
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+    if (led->fade_in > 0 && led->fade_out > 0)
+    {
+        // both fades share the same counter, run every flag
+        flags = 1;
+    }
+    else
+    {
+        unsigned int rate = led->fade_in ? led->fade_in : led->fade_out;
+        int fading = led->fade_in ? led->brightness_value < led->fade_max :
+                                    led->brightness_value > led->fade_min;
+
+        if (rate > 0 && fading)
+        {
+            // a rate lowered in the middle of a fade leaves the counter above it, the tick
+            // keeps counting until it wraps around, so each flag might be the step
+            uint32_t fade_flags = led->fade_counter < rate ? rate - led->fade_counter : 1;
+            if (flags == 0 || fade_flags < flags)
+                flags = fade_flags;
+        }
+    }
+
+#if !defined(LEDZ_GPIO_PWM) && defined(LEDZ_BAM_SUPPORT)
+    // BAM only changes the led in the plane boundaries
+    if (led->brightness && (!led->blink || led->blink_state))
+    {
+        if (led->state ? led->pwm != BAM_MAX : led->pwm != 0)
+            ticks = ledz_ticks_to_bam_boundary(LED_CTX(led));
+    }
+#elif !defined(LEDZ_GPIO_PWM)
+    // internal PWM reloads its counter when it reaches zero, the reload is
+    // ignored when it would load zero again (led already at min or max)
+    if (led->brightness && (!led->blink || led->blink_state))
+    {
+        unsigned int duty = LED_DUTY(led);
+
+        if (led->pwm > 0)
+            ticks = led->pwm;
+        else if ((led->state ? duty != LEDZ_PWM_MAX : duty != 0) || LED_RESIDUAL(led))
+            ticks = 1;
+    }
+#endif
+#endif
+
+#ifdef LEDZ_EASING_SUPPORT
+    // the eased fades can change the brightness in every flag
+    if (led->ease_time > 0)
+        flags = 1;
 #endif
+
+    if (flags > 0)
+    {
+        uint32_t flag_ticks = ledz_flags_to_ticks(LED_CTX(led), flags);
+        if (flag_ticks < ticks)
+            ticks = flag_ticks;
     }
+
+    return ticks;
 }
+
+#ifdef LEDZ_DEADLINE_HEAP
+// insert the led in the heap with the deadline of its next event, its counters must be at the
+// current tick, the leds without events leave the active set
+static void ledz_heap_push(ledz_ctx_t *ctx, ledz_t *led)
+{
+    uint32_t ticks = ledz_busy(led) ? ledz_ticks_to_event(led) : LEDZ_NO_EVENT;
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+    // a finished fade is disabled by the next 1ms flag
+    if (ticks == LEDZ_NO_EVENT && (led->fade_in || led->fade_out))
+        ticks = ledz_flags_to_ticks(ctx, 1);
+#endif
+
+    if (ticks == LEDZ_NO_EVENT)
+    {
+        led->active = 0;
+        return;
+    }
+
+    led->synced = ctx->now;
+    led->deadline = ctx->now + ticks;
+    ledz_heap_up(ctx, led, ctx->heap_count++);
+}
+
+// move the leds of the active set to the heap, in the tick they were changed by its commands
+// and are run by the tick first
+static void ledz_heap_drain(ledz_ctx_t *ctx, int tick, int flag_1ms)
+{
+    ledz_index_t index = __atomic_exchange_n(&ctx->active, INDEX_NONE, __ATOMIC_ACQUIRE);
+
+    while (index != INDEX_NONE)
+    {
+        ledz_t *led = &g_leds[index];
+        index = led->active_next;
+
+        if (tick && ledz_busy(led))
+            ledz_update(led, flag_1ms);
+
+        ledz_heap_push(ctx, led);
+    }
+
+    ctx->heap_on = 1;
+}
+
+// run the leds due in the current tick, the others are not visited
+static void ledz_heap_tick(ledz_ctx_t *ctx, int flag_1ms)
+{
+    ledz_heap_drain(ctx, 1, flag_1ms);
+
+    while (ctx->heap_count > 0 && HEAP_LED(ctx, 0)->deadline == ctx->now)
+    {
+        ledz_t *led = HEAP_LED(ctx, 0);
+
+        ledz_heap_remove(ctx, led);
+        ledz_heap_skip(ctx, led, ctx->now - 1);
+        if (ledz_busy(led))
+            ledz_update(led, flag_1ms);
+
+        ledz_heap_push(ctx, led);
+    }
+}
+
+// give the leds of the heap back to the active set, which the periodic tick iterates, in the
+// order of the instances so the tick reads them in sequence
+static void ledz_heap_stop(ledz_ctx_t *ctx)
+{
+    if (!ctx->heap_on)
+        return;
+
+    for (unsigned int i = ctx->first + ctx->size; i-- > ctx->first; )
+    {
+        ledz_t *led = &g_leds[i];
+        if (ledz_heap_has(ctx, led))
+        {
+            ledz_heap_skip(ctx, led, ctx->now);
+            ledz_active_push(ctx, led);
+        }
+    }
+
+    ctx->heap_count = 0;
+    ctx->heap_on = 0;
+}
+#endif
+
+// ticks until the next tick which changes any led state
+static uint32_t ledz_next_event_ticks(ledz_ctx_t *ctx)
+{
+    uint32_t ticks = LEDZ_NO_EVENT;
+
+#ifdef LEDZ_DEADLINE_HEAP
+    // the leds changed since the last event take their place in the heap
+    ledz_heap_drain(ctx, 0, 0);
+#endif
+
+#ifdef LEDZ_COMMAND_QUEUE
+    // pending commands are applied by the next tick
+    if (!QUEUE_EMPTY(ctx))
+        return 1;
+#endif
+
+#ifdef LEDZ_DEADLINE_HEAP
+    if (ctx->heap_count > 0)
+        ticks = HEAP_LED(ctx, 0)->deadline - ctx->now;
+#else
+    for (ledz_t *led = LED_PTR(ctx->active); led; led = LED_PTR(led->active_next))
+    {
+        if (!ledz_busy(led))
+            continue;
+
+        uint32_t led_ticks = ledz_ticks_to_event(led);
+        if (led_ticks < ticks)
+            ticks = led_ticks;
+    }
+#endif
+
+#ifdef LEDZ_PLAYER_SUPPORT
+    // the players start the next keyframe in the 1ms flag where time reaches zero
+    for (int i = 0; i < LEDZ_MAX_PLAYERS; i++)
+    {
+        ledz_player_t *player = &ctx->players[i];
+        if (!player->seq)
+            continue;
+
+        uint32_t player_ticks = ledz_flags_to_ticks(ctx, player->time > 0 ? player->time : 1);
+        if (player_ticks < ticks)
+            ticks = player_ticks;
+    }
+#endif
+
+    return ticks;
+}
+
+static void ledz_do_set(ledz_t* obj, ledz_color_t color, int value)
+{
+    ledz_t *led;
+
+    // adjust value
+    if (value >= 1)
+        value = 1;
+
+    for (unsigned int slot = 0; (led = ledz_channel(obj, color, &slot)); )
+    {
+        // disable blinking and brightness control of each led of the color
+        led->blink = 0;
+        led->brightness = 0;
+
+#ifdef LEDZ_EASING_SUPPORT
+        led->ease_time = 0;
+#endif
+
+        // skip update if value match current state
+        if (led->state == value)
+            continue;
+
+        // toggle led if value is negative
+        if (value < 0)
+            value = 1 - led->state;
+
+        // update led GPIO
+        LED_SET(led, value);
+    }
+}
+
+static void ledz_do_blink(ledz_t* obj, ledz_color_t color, uint16_t time_on, uint16_t time_off)
+{
+    ledz_t *led;
+
+    for (unsigned int slot = 0; (led = ledz_channel(obj, color, &slot)); )
+    {
+        if (time_on == 0 || time_off == 0)
+        {
+            led->blink = 0;
+            continue;
+        }
+
+        led->time_on = time_on;
+        led->time_off = time_off;
+
+        // load counter according current state
+        if (led->state)
+        {
+            led->blink_state = 1;
+            led->time = time_on;
+        }
+        else
+        {
+            led->blink_state = 0;
+            led->time = time_off;
+        }
+
+        // start blinking
+        led->blink = 1;
+        ledz_activate(led);
+    }
+}
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+static void ledz_set_brightness(ledz_t* led, unsigned int value)
+{
+    // convert brightness value to duty cycle according the led curve
+    unsigned int duty_cycle = ledz_duty(led, value);
+
+    // enable hardware PWM
+    if (duty_cycle > 0 && duty_cycle < LEDZ_PWM_MAX)
+        LED_PWM(led, duty_cycle);
+
+    // does not use PWM if value is min or max
+    else
+        LED_SET(led, duty_cycle > 0);
+
+    // enable brightness control
+#ifndef LEDZ_GPIO_PWM
+    led->pwm = PWM_PHASE(led);
+#endif
+    led->brightness_value = value;
+    LED_BAM(led);
+    led->brightness = 1;
+    ledz_activate(led);
+}
+
+static void ledz_do_brightness(ledz_t* obj, ledz_color_t color, unsigned int value)
+{
+    ledz_t *led;
+
+    if (value >= LEDZ_BRIGHTNESS_MAX)
+        value = LEDZ_BRIGHTNESS_MAX;
+
+    for (unsigned int slot = 0; (led = ledz_channel(obj, color, &slot)); )
+    {
+#ifdef LEDZ_EASING_SUPPORT
+        led->ease_time = 0;
+#endif
+        ledz_set_brightness(led, value);
+    }
+}
+
+#ifdef LEDZ_CURVE_SUPPORT
+static void ledz_do_curve(ledz_t* obj, ledz_color_t color, ledz_curve_t curve)
+{
+    ledz_t *led;
+
+    for (unsigned int slot = 0; (led = ledz_channel(obj, color, &slot)); )
+    {
+        led->curve = curve;
+
+        // apply the new curve to the current brightness
+        if (led->brightness)
+        {
+            LED_PWM(led, LED_DUTY(led));
+            LED_BAM(led);
+        }
+    }
+}
+#endif
+
+static void ledz_do_fade_in(ledz_t* obj, ledz_color_t color, unsigned int rate, unsigned int max)
+{
+    ledz_t *led;
+
+    if (rate > UINT16_MAX)
+        rate = UINT16_MAX;
+
+    if (max > LEDZ_BRIGHTNESS_MAX)
+        max = LEDZ_BRIGHTNESS_MAX;
+
+    for (unsigned int slot = 0; (led = ledz_channel(obj, color, &slot)); )
+    {
+#ifdef LEDZ_EASING_SUPPORT
+        led->ease_time = 0;
+#endif
+        led->fade_in = rate;
+        led->fade_max = max;
+
+        if (!led->brightness)
+        {
+#ifndef LEDZ_GPIO_PWM
+            led->pwm = PWM_PHASE(led);
+#endif
+            led->brightness_value = 0;
+            led->brightness = 1;
+        }
+
+        ledz_activate(led);
+    }
+}
+
+static void ledz_do_fade_out(ledz_t* obj, ledz_color_t color, unsigned int rate, unsigned int min)
+{
+    ledz_t *led;
+
+    if (rate > UINT16_MAX)
+        rate = UINT16_MAX;
+
+    if (min > LEDZ_BRIGHTNESS_MAX)
+        min = LEDZ_BRIGHTNESS_MAX;
+
+    for (unsigned int slot = 0; (led = ledz_channel(obj, color, &slot)); )
+    {
+#ifdef LEDZ_EASING_SUPPORT
+        led->ease_time = 0;
+#endif
+        led->fade_out = rate;
+        led->fade_min = min;
+        ledz_activate(led);
+    }
+}
+
+#ifdef LEDZ_EASING_SUPPORT
+static void ledz_do_fade_to(ledz_t* obj, ledz_color_t color, unsigned int target,
+                            uint16_t duration, unsigned int easing)
+{
+    ledz_t *led;
+
+    if (target > LEDZ_BRIGHTNESS_MAX)
+        target = LEDZ_BRIGHTNESS_MAX;
+
+    // the only division of the fade, the tick adds the step every ms
+    uint16_t step = duration > 0 ? 0xFFFF / duration : 0;
+
+    for (unsigned int slot = 0; (led = ledz_channel(obj, color, &slot)); )
+    {
+        led->fade_in = 0;
+        led->fade_out = 0;
+        led->ease_time = 0;
+
+        // fade from the current state if the brightness control is disabled
+        if (duration == 0 || !led->brightness)
+            ledz_set_brightness(led, duration == 0 ? target : led->state ? LEDZ_BRIGHTNESS_MAX : 0);
+
+        if (duration == 0 || led->brightness_value == target)
+            continue;
+
+        led->ease_from = led->brightness_value;
+        led->ease_to = target;
+        led->ease_phase = 0;
+        led->ease_step = step;
+        led->easing = easing;
+        led->ease_time = duration;
+        ledz_activate(led);
+    }
+}
+#endif
+
+#ifdef LEDZ_RGB_SUPPORT
+static void ledz_do_rgb(ledz_t* obj, unsigned int red, unsigned int green, unsigned int blue)
+{
+    const ledz_color_t rgb = LEDZ_RED | LEDZ_GREEN | LEDZ_BLUE;
+    ledz_t *led;
+
+    for (unsigned int slot = 0; (led = ledz_channel(obj, rgb, &slot)); )
+    {
+        unsigned int value;
+
+        if (led->color & LEDZ_RED)
+            value = red;
+        else if (led->color & LEDZ_GREEN)
+            value = green;
+        else
+            value = blue;
+
+#ifdef LEDZ_EASING_SUPPORT
+        led->ease_time = 0;
+#endif
+        ledz_set_brightness(led, value);
+    }
+}
+
+// the colors are converted in chunks by loops without dependencies between the colors, so
+// the compiler can vectorize them. The RGB components are converted in place, 3 per color,
+// while the HSV colors are split in one array per component
+
+// convert the RGB components to brightness applying the white balance
+static void ledz_rgb_levels(const ledz_rgb_t *colors, uint16_t levels[][3], unsigned int count)
+{
+    const uint32_t red = g_rgb_gain[0], green = g_rgb_gain[1], blue = g_rgb_gain[2];
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        levels[i][0] = (colors[i].red * red + 0x8000) >> 16;
+        levels[i][1] = (colors[i].green * green + 0x8000) >> 16;
+        levels[i][2] = (colors[i].blue * blue + 0x8000) >> 16;
+    }
+}
+
+// component of the HSV color: value - value * saturation * f(hue), where f is a trapezoid of
+// the hue (in 15 bits) shifted by the component offset, 0 from 0 to 1/6, up to 1 at 2/6 and
+// back to 0 from 4/6 to 5/6 of the turn. It only uses 16 bits operations
+static inline uint16_t ledz_hsv_component(uint16_t hue, uint16_t offset, uint16_t value,
+                                          uint16_t vs)
+{
+    int16_t k = (hue + offset) & 0x7FFF;
+    int16_t f = 0x5555 - k;
+
+    f = k < f ? k : f;
+    f = f < 0 ? 0 : f > 0x1555 ? 0x1555 : f;
+
+    // f from 0 to 256
+    uint16_t amount = (f * 3 + 32) >> 6;
+    return value - ((amount * vs) >> 8);
+}
+
+// convert the HSV colors to RGB and then to brightness applying the white balance
+static void ledz_hsv_levels(const ledz_hsv_t *colors, uint16_t levels[3][LEDZ_RGB_CHUNK],
+                            unsigned int count)
+{
+    uint16_t hue[LEDZ_RGB_CHUNK], saturation[LEDZ_RGB_CHUNK], value[LEDZ_RGB_CHUNK];
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        hue[i] = colors[i].hue >> 1;
+        saturation[i] = colors[i].saturation;
+        value[i] = colors[i].value;
+    }
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        // value * saturation from 0 to 255, the saturation 255 is scaled to 256
+        uint16_t vs = (value[i] * (saturation[i] + (saturation[i] >> 7))) >> 8;
+
+        levels[0][i] = ledz_hsv_component(hue[i], 0x6AAB, value[i], vs);
+        levels[1][i] = ledz_hsv_component(hue[i], 0x4000, value[i], vs);
+        levels[2][i] = ledz_hsv_component(hue[i], 0x1555, value[i], vs);
+    }
+
+    for (int c = 0; c < 3; c++)
+    {
+        const uint32_t gain = g_rgb_gain[c];
+
+        for (unsigned int i = 0; i < count; i++)
+            levels[c][i] = (levels[c][i] * gain + 0x8000) >> 16;
+    }
+}
+#endif
+#endif
+
+#ifdef LEDZ_PLAYER_SUPPORT
+static inline unsigned int ledz_keyframe_value(const ledz_keyframe_t *keyframe)
+{
+    unsigned int value = keyframe->brightness;
+    return value > LEDZ_BRIGHTNESS_MAX ? LEDZ_BRIGHTNESS_MAX : value;
+}
+
+static void ledz_keyframe_start(ledz_t *obj, const ledz_keyframe_t *keyframe)
+{
+    unsigned int value = ledz_keyframe_value(keyframe);
+    ledz_t *led;
+
+    for (unsigned int slot = 0; (led = ledz_channel(obj, keyframe->color, &slot)); )
+    {
+        led->fade_in = 0;
+        led->fade_out = 0;
+
+        if (keyframe->interpolation != LEDZ_LINEAR || keyframe->duration == 0)
+        {
+            // avoid restarting the PWM period when the brightness is kept
+            if (!led->brightness || led->brightness_value != value)
+                ledz_set_brightness(led, value);
+
+            continue;
+        }
+
+        // ramp from the current state if the brightness control is disabled
+        if (!led->brightness)
+            ledz_set_brightness(led, led->state ? LEDZ_BRIGHTNESS_MAX : 0);
+
+        if (led->brightness_value == value)
+            continue;
+
+        // use the fade control with the rate which reaches the value in the keyframe duration
+        unsigned int diff = value > led->brightness_value ?
+                            value - led->brightness_value : led->brightness_value - value;
+        unsigned int rate = keyframe->duration / diff;
+
+        led->fade_counter = 0;
+        if (value > led->brightness_value)
+        {
+            led->fade_in = rate > 0 ? rate : 1;
+            led->fade_max = value;
+        }
+        else
+        {
+            led->fade_out = rate > 0 ? rate : 1;
+            led->fade_min = value;
+        }
+
+        ledz_activate(led);
+    }
+}
+
+static void ledz_keyframe_end(ledz_t *obj, const ledz_keyframe_t *keyframe)
+{
+    if (keyframe->interpolation != LEDZ_LINEAR)
+        return;
+
+    unsigned int value = ledz_keyframe_value(keyframe);
+    ledz_t *led;
+
+    // complete the ramps which could not reach the value in time
+    for (unsigned int slot = 0; (led = ledz_channel(obj, keyframe->color, &slot)); )
+    {
+        if (led->brightness_value != value)
+        {
+            led->fade_in = 0;
+            led->fade_out = 0;
+            ledz_set_brightness(led, value);
+        }
+    }
+}
+
+static void ledz_player_update(ledz_player_t *player)
+{
+    if (player->time > 0)
+        player->time--;
+
+    if (player->time > 0)
+        return;
+
+    ledz_t *led = &g_leds[player->led];
+    ledz_keyframe_end(led, &player->seq[player->index]);
+
+    if (++player->index == player->count)
+    {
+        // stop after the last round
+        if (player->repeat == 1)
+        {
+            player->seq = 0;
+            return;
+        }
+
+        if (player->repeat > 1)
+            player->repeat--;
+
+        player->index = 0;
+    }
+
+    ledz_keyframe_start(led, &player->seq[player->index]);
+    player->time = player->seq[player->index].duration;
+}
+
+static void ledz_do_play(ledz_t* led, const ledz_keyframe_t *seq, unsigned int count,
+                         unsigned int repeat)
+{
+    ledz_player_t *players = LED_CTX(led)->players, *player = 0;
+
+    // use the player of the led or a free one
+    for (int i = 0; i < LEDZ_MAX_PLAYERS; i++)
+    {
+        if (players[i].seq && players[i].led == LED_INDEX(led))
+        {
+            player = &players[i];
+            break;
+        }
+
+        if (!players[i].seq && !player)
+            player = &players[i];
+    }
+
+    if (!player)
+        return;
+
+    if (!seq || count == 0)
+    {
+        // stop the ramps keeping the current brightness
+        for (unsigned int i = 0; player->seq && ledz_slot(led, i); i++)
+        {
+            ledz_slot(led, i)->fade_in = 0;
+            ledz_slot(led, i)->fade_out = 0;
+        }
+
+        player->seq = 0;
+        return;
+    }
+
+    player->led = LED_INDEX(led);
+    player->count = count > UINT16_MAX ? UINT16_MAX : count;
+    player->repeat = repeat > UINT16_MAX ? UINT16_MAX : repeat;
+    player->index = 0;
+    player->time = seq[0].duration;
+    player->seq = seq;
+
+    ledz_keyframe_start(led, &seq[0]);
+}
+
+static void ledz_player_stop(ledz_t *led)
+{
+    ledz_player_t *players = LED_CTX(led)->players;
+
+    for (int i = 0; i < LEDZ_MAX_PLAYERS; i++)
+    {
+        if (players[i].led == LED_INDEX(led))
+            players[i].seq = 0;
+    }
+}
+#endif
+
+#ifdef LEDZ_COMMAND_QUEUE
+static ledz_cmd_t* ledz_enqueue(uint8_t op, ledz_t *led, ledz_color_t color,
+                                unsigned int arg1, unsigned int arg2)
+{
+    ledz_ctx_t *ctx = LED_CTX(led);
+
+#ifdef LEDZ_FRAMED_MODE
+    // the commands of the frame are written after the published ones
+    unsigned int tail = ctx->queue_staged;
+
+    // a frame bigger than the queue is split, otherwise the tick could never free a slot
+    if (tail - QUEUE_LOAD(ctx->queue_tail, __ATOMIC_RELAXED) >= LEDZ_QUEUE_SIZE)
+    {
+        QUEUE_STORE(ctx->queue_tail, tail, __ATOMIC_RELEASE);
+        ctx->frame_split = 1;
+    }
+#else
+    // the producer is the only writer of the tail
+    unsigned int tail = QUEUE_LOAD(ctx->queue_tail, __ATOMIC_RELAXED);
+#endif
+
+    // drop the command if the queue is full, waiting the tick to free a slot would never
+    // return when the caller runs in the tick thread or preempts it (e.g. ledz_advance)
+    if (tail - QUEUE_LOAD(ctx->queue_head, __ATOMIC_ACQUIRE) >= LEDZ_QUEUE_SIZE)
+    {
+        ctx->queue_dropped++;
+        return 0;
+    }
+
+    ledz_cmd_t *cmd = &ctx->queue[tail & (LEDZ_QUEUE_SIZE - 1)];
+    cmd->op = op;
+    cmd->led = LED_INDEX(led);
+    cmd->generation = led->generation;
+    cmd->color = color;
+    cmd->arg1 = arg1 > UINT16_MAX ? UINT16_MAX : arg1;
+    cmd->arg2 = arg2 > UINT16_MAX ? UINT16_MAX : arg2;
+
+    return cmd;
+}
+
+static inline void ledz_publish(ledz_ctx_t *ctx)
+{
+#ifdef LEDZ_FRAMED_MODE
+    // the command is kept in the frame until the commit
+    ctx->queue_staged++;
+#else
+    // make the command visible to the tick
+    QUEUE_STORE(ctx->queue_tail, QUEUE_LOAD(ctx->queue_tail, __ATOMIC_RELAXED) + 1,
+                __ATOMIC_RELEASE);
+#endif
+}
+
+static void ledz_dequeue(ledz_ctx_t *ctx)
+{
+    // the tick is the only writer of the head
+    unsigned int head = QUEUE_LOAD(ctx->queue_head, __ATOMIC_RELAXED);
+    unsigned int tail = QUEUE_LOAD(ctx->queue_tail, __ATOMIC_ACQUIRE);
+
+#ifdef LEDZ_FRAMED_MODE
+    // the GPIO is written once per led after all commands of the frame
+    ctx->framing = (head != tail);
+#endif
+
+    for (; head != tail; head++)
+    {
+        ledz_cmd_t *cmd = &ctx->queue[head & (LEDZ_QUEUE_SIZE - 1)];
+        ledz_t *led = &g_leds[cmd->led];
+
+        // ignore commands of destroyed leds, even when the instance was taken by a new led
+        if (!led->used || led->generation != cmd->generation)
+            continue;
+
+        switch (cmd->op)
+        {
+            case CMD_SET:
+                ledz_do_set(led, cmd->color, cmd->arg1);
+                break;
+
+            case CMD_TOGGLE:
+                ledz_do_set(led, cmd->color, -1);
+                break;
+
+            case CMD_BLINK:
+                ledz_do_blink(led, cmd->color, cmd->arg1, cmd->arg2);
+                break;
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+            case CMD_BRIGHTNESS:
+                ledz_do_brightness(led, cmd->color, cmd->arg1);
+                break;
+
+#ifdef LEDZ_CURVE_SUPPORT
+            case CMD_CURVE:
+                ledz_do_curve(led, cmd->color, cmd->arg1);
+                break;
+#endif
+
+            case CMD_FADE_IN:
+                ledz_do_fade_in(led, cmd->color, cmd->arg1, cmd->arg2);
+                break;
+
+            case CMD_FADE_OUT:
+                ledz_do_fade_out(led, cmd->color, cmd->arg1, cmd->arg2);
+                break;
+
+#ifdef LEDZ_EASING_SUPPORT
+            case CMD_FADE_TO:
+                ledz_do_fade_to(led, cmd->color, cmd->arg1, cmd->arg2, cmd->easing);
+                break;
+#endif
+
+#ifdef LEDZ_RGB_SUPPORT
+            case CMD_RGB:
+                ledz_do_rgb(led, cmd->arg1, cmd->arg2, cmd->arg3);
+                break;
+#endif
+#endif
+
+#ifdef LEDZ_PLAYER_SUPPORT
+            case CMD_PLAY:
+                ledz_do_play(led, cmd->seq, cmd->arg1, cmd->arg2);
+                break;
+#endif
+        }
+    }
+
+#ifdef LEDZ_FRAMED_MODE
+    ctx->framing = 0;
+    ledz_frame_flush(ctx);
+#endif
+
+    // release the slots to the producer
+    QUEUE_STORE(ctx->queue_head, head, __ATOMIC_RELEASE);
+}
+#endif
+
+static ledz_t* ledz_new(ledz_ctx_t *ctx, ledz_type_t type, const ledz_color_t *colors,
+                        const int *pins)
+{
+    if (type > LEDZ_3COLOR || ctx->available < type)
+        return 0;
+
+    // the port and pin are stored in 8 and 16 bits
+    for (unsigned int i = 0; i < type; i++)
+    {
+        if (pins[i * 2] < 0 || pins[i * 2] > UINT8_MAX ||
+            pins[i * 2 + 1] < 0 || pins[i * 2 + 1] > UINT16_MAX)
+            return 0;
+    }
+
+    ledz_t *obj = 0, *led = 0;
+
+    for (unsigned int i = 0; i < type; i++)
+    {
+#ifdef LEDZ_ARENA_SUPPORT
+        led = ledz_take(ctx);
+#else
+        // the next led is searched after the previous one
+        led = ledz_take(ctx, led ? LED_INDEX(led) + 1u : ctx->first);
+#endif
+        led->color = colors[i];
+        led->port = pins[i * 2];
+        led->pin = pins[i * 2 + 1];
+        led->used = 1;
+        led->state = 0;
+        led->blink = 0;
+        led->curve = LEDZ_CURVE_CIE1931;
+#ifdef LEDZ_EASING_SUPPORT
+        led->ease_time = 0;
+#endif
+#ifdef LEDZ_DITHER_SUPPORT
+        // the error accumulated by the previous owner of the instance is dropped
+        led->dither = 0;
+        led->dither_carry = 0;
+#endif
+#ifdef LEDZ_GROUP_SUPPORT
+        led->master = 0;
+        led->member = 0;
+#endif
+#ifdef LEDZ_CONTEXT_SUPPORT
+        led->ctx = ctx - g_contexts;
+#endif
+
+        // the first led keeps the channel table of the object
+        if (i == 0)
+        {
+            obj = led;
+            for (unsigned int slot = 0; slot < LEDZ_3COLOR - 1; slot++)
+                obj->channel[slot] = INDEX_NONE;
+        }
+        else
+        {
+            obj->channel[i - 1] = LED_INDEX(led);
+            obj->channel_color[i - 1] = led->color;
+        }
+    }
+
+    return obj;
+}
+
+#ifdef LEDZ_GROUP_SUPPORT
+static ledz_group_t* ledz_group_new(ledz_ctx_t *ctx)
+{
+    // the group is a led without GPIO which matches any color
+    ledz_t *group = ledz_new(ctx, LEDZ_1COLOR, (const ledz_color_t []){0xFF}, (const int []){0, 0});
+    if (group)
+    {
+        group->master = 1;
+        group->group_next = INDEX_NONE;
+    }
+
+    return group;
+}
+#endif
+
+#ifdef LEDZ_FRAMED_MODE
+static inline int ledz_do_commit(ledz_ctx_t *ctx)
+{
+    // publish all commands of the frame at once, the next tick applies them together
+    QUEUE_STORE(ctx->queue_tail, ctx->queue_staged, __ATOMIC_RELEASE);
+
+    int split = ctx->frame_split;
+    ctx->frame_split = 0;
+
+    return split ? -1 : 0;
+}
+#endif
+
+// run the leds of the active set, dropping the idle ones
+static void ledz_active_tick(ledz_ctx_t *ctx, int flag_1ms)
+{
+    ledz_index_t *link = &ctx->active;
+    while (*link != INDEX_NONE)
+    {
+        ledz_t *led = &g_leds[*link];
+
+        if (!ledz_busy(led))
+        {
+            // drop idle led from the active set, the head is only dropped when ledz_activate
+            // has not pushed a new one meanwhile, otherwise the link now holds the new head and
+            // the led is dropped after it
+            if (link == &ctx->active)
+            {
+                ledz_index_t head = LED_INDEX(led);
+                if (!ACTIVE_CAS(ctx, head, led->active_next))
+                    continue;
+            }
+            else
+            {
+                *link = led->active_next;
+            }
+
+            led->active = 0;
+            continue;
+        }
+
+        link = &led->active_next;
+        ledz_update(led, flag_1ms);
+    }
+}
+
+static void ledz_do_tick(ledz_ctx_t *ctx)
+{
+    int flag_1ms = 0;
+
+#ifdef LEDZ_DEADLINE_HEAP
+    // the commands and players change the leds before the tick runs them
+    ctx->now++;
+    ctx->ticking = 1;
+#endif
+
+    // check if 1ms has been passed
+    if (++ctx->counter_1ms >= CTX_TICKS_TO_1ms(ctx))
+    {
+        ctx->counter_1ms = 0;
+        flag_1ms = 1;
+    }
+
+#ifdef LEDZ_BAM_SUPPORT
+    ledz_bam_advance(ctx, 1);
+#endif
+
+#ifdef LEDZ_PWM_STAGGER
+    ctx->pwm_edges = 0;
+#endif
+
+#ifdef LEDZ_COMMAND_QUEUE
+    // apply the commands issued since the last tick
+    ledz_dequeue(ctx);
+#endif
+
+#ifdef LEDZ_PLAYER_SUPPORT
+    // advance the keyframe sequences
+    if (flag_1ms)
+    {
+        for (int i = 0; i < LEDZ_MAX_PLAYERS; i++)
+        {
+            if (ctx->players[i].seq)
+                ledz_player_update(&ctx->players[i]);
+        }
+    }
+#endif
+
+    // iterate only the leds with pending work, in the tickless mode only the due ones
+#ifdef LEDZ_DEADLINE_HEAP
+    ctx->ticking = 0;
+    if (ctx->heap_on)
+        ledz_heap_tick(ctx, flag_1ms);
+    else
+        ledz_active_tick(ctx, flag_1ms);
+#else
+    ledz_active_tick(ctx, flag_1ms);
+#endif
+
+#ifdef LEDZ_GPIO_WRITE_PORT
+    // write the GPIO changes of all leds once per port
+    ledz_port_flush(ctx);
+#endif
+}
+
+#ifdef LEDZ_STATS_SUPPORT
+static void ledz_stats_add(ledz_ctx_t *ctx, uint32_t cycles)
+{
+    ledz_stats_t *stats = &ctx->stats;
+
+    if (stats->ticks == 0 || cycles < stats->cycles_min)
+        stats->cycles_min = cycles;
+
+    if (cycles > stats->cycles_max)
+        stats->cycles_max = cycles;
+
+    if (cycles > CTX_TICK_PERIOD(ctx) * LEDZ_STATS_CYCLES_PER_US)
+        stats->overruns++;
+
+    // the bucket is the most significant bit of the cycles
+    stats->histogram[31 - __builtin_clz(cycles | 1)]++;
+    ctx->stats_cycles += cycles;
+    stats->ticks++;
+}
+
+static void ledz_do_stats_get(ledz_ctx_t *ctx, ledz_stats_t *stats)
+{
+    *stats = ctx->stats;
+    stats->cycles_avg = stats->ticks ? ctx->stats_cycles / stats->ticks : 0;
+}
+
+static void ledz_do_stats_reset(ledz_ctx_t *ctx)
+{
+    ctx->stats = (ledz_stats_t) {0};
+    ctx->stats_cycles = 0;
+
+    for (unsigned int i = ctx->first; i < ctx->first + ctx->size; i++)
+    {
+        g_leds[i].gpio_writes = 0;
+        g_leds[i].pwm_writes = 0;
+    }
+}
+#endif
+
+// tick called by the timer or by ledz_advance, measured by the statistics
+static inline void ledz_timer_tick(ledz_ctx_t *ctx)
+{
+#ifdef LEDZ_STATS_SUPPORT
+    uint32_t start = LEDZ_STATS_CYCLES();
+    ledz_do_tick(ctx);
+    ledz_stats_add(ctx, LEDZ_STATS_CYCLES() - start);
+#else
+    ledz_do_tick(ctx);
+#endif
+}
+
+static uint32_t ledz_do_next_event_us(ledz_ctx_t *ctx)
+{
+    uint32_t ticks = ledz_next_event_ticks(ctx);
+
+    if (ticks > LEDZ_NO_EVENT / CTX_TICK_PERIOD(ctx))
+        return LEDZ_NO_EVENT;
+
+    // discount the time already elapsed towards the next tick
+    return ticks * CTX_TICK_PERIOD(ctx) - ctx->elapsed_us;
+}
+
+static void ledz_do_advance(ledz_ctx_t *ctx, uint32_t elapsed_us)
+{
+    // convert elapsed time to ticks keeping the remainder for the next call
+    uint32_t ticks = elapsed_us / CTX_TICK_PERIOD(ctx);
+    ctx->elapsed_us += elapsed_us % CTX_TICK_PERIOD(ctx);
+    if (ctx->elapsed_us >= CTX_TICK_PERIOD(ctx))
+    {
+        ctx->elapsed_us -= CTX_TICK_PERIOD(ctx);
+        ticks++;
+    }
+
+    while (ticks > 0)
+    {
+        // find the next tick which changes any led state
+        uint32_t next = ledz_next_event_ticks(ctx);
+
+        // fast forward the idle ticks
+        uint32_t idle = next > ticks ? ticks : next - 1;
+        if (idle > 0)
+        {
+            uint32_t counter = ctx->counter_1ms + idle;
+            uint32_t flags = counter / CTX_TICKS_TO_1ms(ctx);
+            ctx->counter_1ms = counter % CTX_TICKS_TO_1ms(ctx);
+
+#ifdef LEDZ_BAM_SUPPORT
+            ledz_bam_advance(ctx, idle);
+#endif
+
+#ifdef LEDZ_DEADLINE_HEAP
+            // the leds of the heap catch up when they are due or changed
+            ctx->now += idle;
+            (void) flags;
+#else
+            for (ledz_t *led = LED_PTR(ctx->active); led; led = LED_PTR(led->active_next))
+            {
+                if (ledz_busy(led))
+                    ledz_skip(led, idle, flags);
+            }
+#endif
+
+#ifdef LEDZ_PLAYER_SUPPORT
+            for (int i = 0; i < LEDZ_MAX_PLAYERS; i++)
+            {
+                if (ctx->players[i].seq && ctx->players[i].time > 0)
+                    ctx->players[i].time -= flags;
+            }
+#endif
+
+            ticks -= idle;
+        }
+
+        // run the tick where the event happens, measured by the statistics as a timer tick
+        if (ticks > 0)
+        {
+            ledz_timer_tick(ctx);
+            ticks--;
+        }
+    }
+}
+
+/*
+****************************************************************************************************
+*       GLOBAL FUNCTIONS
+****************************************************************************************************
+*/
+
+#ifdef LEDZ_ARENA_SUPPORT
+unsigned int ledz_init(void *arena, size_t bytes)
+{
+    ledz_ctx_t *ctx = g_contexts;
+
+    if (g_leds || !arena)
+        return 0;
+
+    uintptr_t start = ((uintptr_t) arena + ARENA_ALIGN - 1) & ~((uintptr_t) ARENA_ALIGN - 1);
+    size_t skip = start - (uintptr_t) arena;
+    if (bytes < skip + sizeof(ledz_t))
+        return 0;
+
+    // the index type is sized by LEDZ_MAX_INSTANCES
+    unsigned int count = (bytes - skip) / sizeof(ledz_t);
+    if (count > LEDZ_MAX_INSTANCES)
+        count = LEDZ_MAX_INSTANCES;
+
+    g_leds = (ledz_t *) start;
+    g_leds_count = count;
+    for (unsigned int i = 0; i < count; i++)
+        g_leds[i] = (ledz_t) {0};
+
+    ctx->size = count;
+    ctx->available = count;
+
+    return count;
+}
+
+size_t ledz_instance_size(void)
+{
+    return sizeof(ledz_t);
+}
+
+ledz_handle_t ledz_handle(ledz_t *led)
+{
+    if (!led)
+        return 0;
+
+    // the index is stored plus one, so zero is not a valid handle
+    return (ledz_handle_t) led->generation << 16 | (LED_INDEX(led) + 1u);
+}
+
+ledz_t* ledz_resolve(ledz_handle_t handle)
+{
+    unsigned int index = (handle & 0xFFFF) - 1;
+    if (index >= g_leds_count)
+        return 0;
+
+    ledz_t *led = &g_leds[index];
+    if (!led->used || led->generation != (uint8_t) (handle >> 16))
+        return 0;
+
+    return led;
+}
+#endif
+
+ledz_t* ledz_create(ledz_type_t type, const ledz_color_t *colors, const int *pins)
+{
+    return ledz_new(g_contexts, type, colors, pins);
+}
+
+void ledz_destroy(ledz_t* led)
+{
+#ifdef LEDZ_ARENA_SUPPORT
+    // a second destroy would add the object twice to the free list
+    if (!led->used)
+        return;
+
+    unsigned int count = 0;
+#endif
+
+    ledz_t *obj = led;
+
+    for (unsigned int slot = 0; (led = ledz_slot(obj, slot)); slot++)
+    {
+#ifdef LEDZ_GROUP_SUPPORT
+        // release the members of a group or leave the group of a member
+        while (led->master && led->group_next != INDEX_NONE)
+            ledz_group_unlink(led, &g_leds[led->group_next]);
+
+        ledz_group_leave(led);
+#endif
+
+#ifdef LEDZ_PLAYER_SUPPORT
+        ledz_player_stop(led);
+#endif
+
+        ledz_give(led);
+#ifdef LEDZ_ARENA_SUPPORT
+        count++;
+#endif
+    }
+
+#ifdef LEDZ_ARENA_SUPPORT
+    // the instances are pushed backwards, so a new object of the same type takes them in order
+    while (count--)
+        ledz_free_push(LED_CTX(obj), ledz_slot(obj, count));
+#endif
+}
+
+#ifdef LEDZ_GROUP_SUPPORT
+ledz_group_t* ledz_group_create(void)
+{
+    return ledz_group_new(g_contexts);
+}
+
+void ledz_group_destroy(ledz_group_t* group)
+{
+    ledz_destroy(group);
+}
+
+void ledz_group_add(ledz_group_t* group, ledz_t* obj, ledz_color_t color)
+{
+    ledz_t *led;
+
+    for (unsigned int slot = 0; (led = ledz_channel(obj, color, &slot)); )
+    {
+        if (!led->member && !led->master)
+        {
+#ifdef LEDZ_CONTEXT_SUPPORT
+            // the members are updated by the tick of the group
+            if (led->ctx != group->ctx)
+                continue;
+#endif
+
+            // the new member starts with the group state
+            LED_SET(led, group->state);
+
+            led->group_next = group->group_next;
+            group->group_next = LED_INDEX(led);
+            led->member = 1;
+        }
+    }
+}
+
+void ledz_group_remove(ledz_group_t* group, ledz_t* obj, ledz_color_t color)
+{
+    ledz_t *led;
+
+    for (unsigned int slot = 0; (led = ledz_channel(obj, color, &slot)); )
+    {
+        if (led->member)
+            ledz_group_unlink(group, led);
+    }
+}
+#endif
+
+void ledz_on(ledz_t* led, ledz_color_t color)
+{
+    ledz_set(led, color, 1);
+}
+
+void ledz_off(ledz_t* led, ledz_color_t color)
+{
+    ledz_set(led, color, 0);
+}
+
+void ledz_toggle(ledz_t* led, ledz_color_t color)
+{
+    ledz_set(led, color, -1);
+}
+
+void ledz_set(ledz_t* led, ledz_color_t color, int value)
+{
+#ifdef LEDZ_COMMAND_QUEUE
+    ledz_cmd_t *cmd;
+
+    if (value < 0)
+        cmd = ledz_enqueue(CMD_TOGGLE, led, color, 0, 0);
+    else
+        cmd = ledz_enqueue(CMD_SET, led, color, value > 0, 0);
+
+    if (cmd)
+        ledz_publish(LED_CTX(led));
+#else
+    ledz_do_set(led, color, value);
+#endif
+}
+
+void ledz_blink(ledz_t* led, ledz_color_t color, uint16_t time_on, uint16_t time_off)
+{
+#ifdef LEDZ_COMMAND_QUEUE
+    if (ledz_enqueue(CMD_BLINK, led, color, time_on, time_off))
+        ledz_publish(LED_CTX(led));
+#else
+    ledz_do_blink(led, color, time_on, time_off);
+#endif
+}
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+void ledz_brightness(ledz_t* led, ledz_color_t color, unsigned int value)
+{
+#ifdef LEDZ_COMMAND_QUEUE
+    if (ledz_enqueue(CMD_BRIGHTNESS, led, color, value, 0))
+        ledz_publish(LED_CTX(led));
+#else
+    ledz_do_brightness(led, color, value);
+#endif
+}
+
+#ifdef LEDZ_CURVE_SUPPORT
+void ledz_curve(ledz_t* led, ledz_color_t color, ledz_curve_t curve)
+{
+#ifdef LEDZ_COMMAND_QUEUE
+    if (ledz_enqueue(CMD_CURVE, led, color, curve, 0))
+        ledz_publish(LED_CTX(led));
+#else
+    ledz_do_curve(led, color, curve);
+#endif
+}
+#endif
+
+void ledz_fade_in(ledz_t* led, ledz_color_t color, unsigned int rate, unsigned int max)
+{
+#ifdef LEDZ_COMMAND_QUEUE
+    if (ledz_enqueue(CMD_FADE_IN, led, color, rate, max))
+        ledz_publish(LED_CTX(led));
+#else
+    ledz_do_fade_in(led, color, rate, max);
+#endif
+}
+
+void ledz_fade_out(ledz_t* led, ledz_color_t color, unsigned int rate, unsigned int min)
+{
+#ifdef LEDZ_COMMAND_QUEUE
+    if (ledz_enqueue(CMD_FADE_OUT, led, color, rate, min))
+        ledz_publish(LED_CTX(led));
+#else
+    ledz_do_fade_out(led, color, rate, min);
+#endif
+}
+
+#ifdef LEDZ_EASING_SUPPORT
+void ledz_fade_to(ledz_t* led, ledz_color_t color, unsigned int target, uint16_t duration,
+                  ledz_easing_t easing)
+{
+#ifdef LEDZ_COMMAND_QUEUE
+    ledz_cmd_t *cmd = ledz_enqueue(CMD_FADE_TO, led, color, target, duration);
+    if (cmd)
+    {
+        cmd->easing = easing;
+        ledz_publish(LED_CTX(led));
+    }
+#else
+    ledz_do_fade_to(led, color, target, duration, easing);
+#endif
+}
+#endif
+
+#ifdef LEDZ_RGB_SUPPORT
+// set the converted colors, the components of each led are step elements apart
+static void ledz_rgb_apply(ledz_t* const *leds, const uint16_t *red, const uint16_t *green,
+                           const uint16_t *blue, unsigned int step, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++, red += step, green += step, blue += step)
+    {
+#ifdef LEDZ_COMMAND_QUEUE
+        ledz_cmd_t *cmd = ledz_enqueue(CMD_RGB, leds[i], 0, *red, *green);
+        if (cmd)
+        {
+            cmd->arg3 = *blue;
+            ledz_publish(LED_CTX(leds[i]));
+        }
+#else
+        ledz_do_rgb(leds[i], *red, *green, *blue);
+#endif
+    }
+}
+
+void ledz_rgb_balance(uint8_t red, uint8_t green, uint8_t blue)
+{
+    g_rgb_gain[0] = RGB_GAIN(red);
+    g_rgb_gain[1] = RGB_GAIN(green);
+    g_rgb_gain[2] = RGB_GAIN(blue);
+}
+
+void ledz_set_rgb(ledz_t* led, uint8_t red, uint8_t green, uint8_t blue)
+{
+    ledz_set_rgb_batch(&led, &(ledz_rgb_t){red, green, blue}, 1);
+}
+
+void ledz_set_hsv(ledz_t* led, uint16_t hue, uint8_t saturation, uint8_t value)
+{
+    ledz_set_hsv_batch(&led, &(ledz_hsv_t){hue, saturation, value}, 1);
+}
+
+void ledz_set_rgb_batch(ledz_t* const *leds, const ledz_rgb_t *colors, unsigned int count)
+{
+    uint16_t levels[LEDZ_RGB_CHUNK][3];
+
+    for (unsigned int i = 0; i < count; i += LEDZ_RGB_CHUNK)
+    {
+        unsigned int chunk = count - i < LEDZ_RGB_CHUNK ? count - i : LEDZ_RGB_CHUNK;
+
+        ledz_rgb_levels(&colors[i], levels, chunk);
+        ledz_rgb_apply(&leds[i], &levels[0][0], &levels[0][1], &levels[0][2], 3, chunk);
+    }
+}
+
+void ledz_set_hsv_batch(ledz_t* const *leds, const ledz_hsv_t *colors, unsigned int count)
+{
+    uint16_t levels[3][LEDZ_RGB_CHUNK];
+
+    for (unsigned int i = 0; i < count; i += LEDZ_RGB_CHUNK)
+    {
+        unsigned int chunk = count - i < LEDZ_RGB_CHUNK ? count - i : LEDZ_RGB_CHUNK;
+
+        ledz_hsv_levels(&colors[i], levels, chunk);
+        ledz_rgb_apply(&leds[i], levels[0], levels[1], levels[2], 1, chunk);
+    }
+}
+#endif
+#endif
+
+#ifdef LEDZ_PLAYER_SUPPORT
+void ledz_play(ledz_t* led, const ledz_keyframe_t *seq, unsigned int count, unsigned int repeat)
+{
+#ifdef LEDZ_COMMAND_QUEUE
+    ledz_cmd_t *cmd = ledz_enqueue(CMD_PLAY, led, 0, seq ? count : 0, repeat);
+    if (cmd)
+    {
+        cmd->seq = seq;
+        ledz_publish(LED_CTX(led));
+    }
+#else
+    ledz_do_play(led, seq, count, repeat);
+#endif
+}
+#endif
+
+#ifdef LEDZ_FRAMED_MODE
+int ledz_commit(void)
+{
+    return ledz_do_commit(g_contexts);
+}
+#endif
+
+#ifdef LEDZ_COMMAND_QUEUE
+unsigned int ledz_queue_dropped(void)
+{
+    return g_contexts->queue_dropped;
+}
+#endif
+
+void ledz_tick(void)
+{
+#ifdef LEDZ_DEADLINE_HEAP
+    ledz_heap_stop(g_contexts);
+#endif
+    ledz_timer_tick(g_contexts);
+}
+
+uint32_t ledz_next_event_us(void)
+{
+    return ledz_do_next_event_us(g_contexts);
+}
+
+void ledz_advance(uint32_t elapsed_us)
+{
+    ledz_do_advance(g_contexts, elapsed_us);
+}
+
+#ifdef LEDZ_STATS_SUPPORT
+void ledz_stats_get(ledz_stats_t *stats)
+{
+    ledz_do_stats_get(g_contexts, stats);
+}
+
+void ledz_stats_led(ledz_t* led, ledz_color_t color, ledz_led_stats_t *stats)
+{
+    stats->gpio_writes = 0;
+    stats->pwm_writes = 0;
+
+    ledz_t *obj = led;
+
+    for (unsigned int slot = 0; (led = ledz_channel(obj, color, &slot)); )
+    {
+        stats->gpio_writes += led->gpio_writes;
+        stats->pwm_writes += led->pwm_writes;
+    }
+}
+
+void ledz_stats_reset(void)
+{
+    ledz_do_stats_reset(g_contexts);
+}
+#endif
+
+#ifdef LEDZ_CONTEXT_SUPPORT
+ledz_ctx_t* ledz_ctx_create(unsigned int instances, unsigned int tick_period,
+                            const ledz_gpio_t *gpio)
+{
+    ledz_ctx_t *def = g_contexts;
+
+    if (g_contexts_count == MAX_CONTEXTS || tick_period == 0 || tick_period > 1000)
+        return 0;
+
+    // the instances are taken from the end of the default context, which must be unused
+    if (instances > def->size)
+        return 0;
+
+    unsigned int first = def->first + def->size - instances;
+
+#ifdef LEDZ_CACHE_LINE
+    // start the context in a new cache line, the instances in between are also taken
+    while (first > def->first && (first * sizeof(ledz_t)) % LEDZ_CACHE_LINE)
+        first--;
+
+    instances = def->first + def->size - first;
+#endif
+
+    for (unsigned int i = first; i < first + instances; i++)
+    {
+        if (g_leds[i].used || g_leds[i].active)
+            return 0;
+    }
+
+#ifdef LEDZ_ARENA_SUPPORT
+    // the free list of the default context only holds instances before the never used ones
+    if (first < def->first + def->fresh)
+        return 0;
+#endif
+
+    def->size -= instances;
+    def->available -= instances;
+
+    ledz_ctx_t *ctx = &g_contexts[g_contexts_count++];
+    ctx->first = first;
+    ctx->size = instances;
+    ctx->available = instances;
+#ifdef LEDZ_ARENA_SUPPORT
+    ctx->free = INDEX_NONE;
+#endif
+    ctx->active = INDEX_NONE;
+#ifdef LEDZ_FRAMED_MODE
+    ctx->dirty = INDEX_NONE;
+#endif
+    ctx->tick_period = tick_period;
+    ctx->ticks_1ms = TICKS_TO_1ms(tick_period);
+
+    if (gpio)
+        ctx->gpio = *gpio;
+
+    return ctx;
+}
+
+int ledz_ctx_destroy(ledz_ctx_t* ctx)
+{
+    ledz_ctx_t *def = g_contexts;
+
+    // the instances go back to the end of the default context, so only the last context can
+    // be destroyed
+    if (ctx == def || ctx != &g_contexts[g_contexts_count - 1] || ctx->available != ctx->size)
+        return -1;
+
+    // the destroyed leds might still be in the active set or dirty, both dropped with the context
+    for (unsigned int i = ctx->first; i < ctx->first + ctx->size; i++)
+    {
+        g_leds[i].active = 0;
+#ifdef LEDZ_FRAMED_MODE
+        g_leds[i].dirty = 0;
+#endif
+    }
+
+    def->size += ctx->size;
+    def->available += ctx->size;
+
+    // the next context starts from the zeroed state of the unused ones
+    *ctx = (ledz_ctx_t) {0};
+    g_contexts_count--;
+
+    return 0;
+}
+
+ledz_t* ledz_ctx_led_create(ledz_ctx_t* ctx, ledz_type_t type, const ledz_color_t *colors,
+                            const int *pins)
+{
+    return ledz_new(ctx, type, colors, pins);
+}
+
+#ifdef LEDZ_GROUP_SUPPORT
+ledz_group_t* ledz_ctx_group_create(ledz_ctx_t* ctx)
+{
+    return ledz_group_new(ctx);
+}
+#endif
+
+void ledz_ctx_tick(ledz_ctx_t* ctx)
+{
+#ifdef LEDZ_DEADLINE_HEAP
+    ledz_heap_stop(ctx);
+#endif
+    ledz_timer_tick(ctx);
+}
+
+uint32_t ledz_ctx_next_event_us(ledz_ctx_t* ctx)
+{
+    return ledz_do_next_event_us(ctx);
+}
+
+void ledz_ctx_advance(ledz_ctx_t* ctx, uint32_t elapsed_us)
+{
+    ledz_do_advance(ctx, elapsed_us);
+}
+
+#ifdef LEDZ_FRAMED_MODE
+int ledz_ctx_commit(ledz_ctx_t* ctx)
+{
+    return ledz_do_commit(ctx);
+}
+#endif
+
+#ifdef LEDZ_COMMAND_QUEUE
+unsigned int ledz_ctx_queue_dropped(ledz_ctx_t* ctx)
+{
+    return ctx->queue_dropped;
+}
+#endif
+
+#ifdef LEDZ_STATS_SUPPORT
+void ledz_ctx_stats_get(ledz_ctx_t* ctx, ledz_stats_t *stats)
+{
+    ledz_do_stats_get(ctx, stats);
+}
+
+void ledz_ctx_stats_reset(ledz_ctx_t* ctx)
+{
+    ledz_do_stats_reset(ctx);
+}
+#endif
+#endif
@@ -37,11 +37,30 @@ extern "C"
 ****************************************************************************************************
 */
 
+#include <stddef.h>
 #include <stdint.h>
 
 // adjust the header according your library
 #include "gpio.h"
 
+#ifdef LEDZ_LINUX_SUPPORT
+// output functions of the Linux runtime (see ledz_linux.h)
+void ledz_linux_output_set(int port, int pin, int value);
+void ledz_linux_output_pwm(int port, int pin, int duty);
+#endif
+
+#ifdef LEDZ_STRIP_SUPPORT
+// output functions of the addressable strips (see ledz_strip.h)
+void ledz_strip_set(int port, int pin, int value);
+void ledz_strip_pwm(int port, int pin, int duty);
+#endif
+
+#ifdef LEDZ_WAVEFORM_SUPPORT
+// output functions of the PWM waveform tables (see ledz_waveform.h)
+void ledz_waveform_set(int port, int pin, int value);
+void ledz_waveform_pwm(int port, int pin, int duty);
+#endif
+
 
 /*
 ****************************************************************************************************
@@ -51,6 +70,12 @@ extern "C"
 
 #define LEDZ_VERSION     "1.1.0"
 
+// value returned by ledz_next_event_us when no LED has pending work
+#define LEDZ_NO_EVENT    UINT32_MAX
+
+// hue of ledz_hsv_t from degrees, a full turn is 65536 so the hue wraps around on overflow
+#define LEDZ_HUE(degrees)   ((uint16_t) ((degrees) * 65536UL / 360))
+
 
 /*
 ****************************************************************************************************
@@ -58,26 +83,225 @@ extern "C"
 ****************************************************************************************************
 */
 
+// the configuration macros below can also be overridden from the compiler command line
+// e.g.: make CONFIG="-DLEDZ_MAX_INSTANCES=64"
+
+// enable/disable the Linux userspace runtime (see ledz_linux.h)
+// the tick is run by a timer thread and, unless LEDZ_GPIO_SET is defined, the GPIO
+// is written through the output backend selected when the runtime is started
+//#define LEDZ_LINUX_SUPPORT
+
 // configure the function to set a GPIO
+#ifndef LEDZ_GPIO_SET
+#ifdef LEDZ_LINUX_SUPPORT
+#define LEDZ_GPIO_SET(port,pin,value)   ledz_linux_output_set(port,pin,value)
+#else
 #define LEDZ_GPIO_SET(port,pin,value)   gpio_set(port,pin,value)
+#endif
+#endif
 
 // configure the function to set the PWM of a GPIO
 // when the below macro is not defined (default) the PWM is generated internally
-// in this case the PWM frequency = 1 / (LEDZ_TICK_PERIOD * 1E-6 * 100)
+// in this case the PWM frequency = 1 / (LEDZ_TICK_PERIOD * 1E-6 * LEDZ_PWM_MAX)
+// the duty argument goes from 0 to LEDZ_PWM_MAX (100 by default)
 //#define LEDZ_GPIO_PWM(port,pin,duty)    gpio_pwm(port,pin,duty)
 
+// configure the function to write several pins of a GPIO port at once (optional)
+// when defined, the GPIO changes made by the tick are grouped by port and written
+// in a single call at the end of the tick, e.g. using a set/reset register
+// the mask and values arguments are uint32_t where the bit n represents the pin n
+// pins from 32 on fall back to LEDZ_GPIO_SET
+//#define LEDZ_GPIO_WRITE_PORT(port,mask,values)  gpio_write_port(port,mask,values)
+
+// maximum of GPIO ports written by the tick when LEDZ_GPIO_WRITE_PORT is defined
+// pins of exceeding ports fall back to LEDZ_GPIO_SET
+#ifndef LEDZ_MAX_PORTS
+#define LEDZ_MAX_PORTS          4
+#endif
+
 // maximum of LEDs to control (note: RGB count as 3 LEDs)
+#ifndef LEDZ_MAX_INSTANCES
 #define LEDZ_MAX_INSTANCES      3
+#endif
+
+// RAM budget in bytes for all LED instances (optional)
+// when defined the build fails if the LEDs do not fit in the budget
+// run "make ram-report" in the bench directory to see the bytes per instance
+//#define LEDZ_RAM_BUDGET         256
+
+// enable/disable the runtime arena (optional)
+// when defined the LED instances are placed by ledz_init in a buffer given at runtime, up to
+// LEDZ_MAX_INSTANCES, instead of a static array. The free instances are kept in a list, so
+// ledz_create and ledz_destroy take constant time, and each instance has a generation
+// counter which detects the use of a destroyed object through its handle (see ledz_handle).
+// Costs one index and one byte per instance
+//#define LEDZ_ARENA_SUPPORT
 
 // configure the logic value which the led turn on (must be 0 or 1)
+#ifndef LEDZ_TURN_ON_VALUE
 #define LEDZ_TURN_ON_VALUE      1
+#endif
 
 // enable/disable brightness support
 // disabling the brightness saves RAM and program memory
+// (it can also be disabled from the command line defining LEDZ_NO_BRIGHTNESS_SUPPORT)
+#ifndef LEDZ_NO_BRIGHTNESS_SUPPORT
 #define LEDZ_BRIGHTNESS_SUPPORT
+#endif
+
+// brightness resolution in bits (optional)
+// when not defined the brightness and the duty cycle go from 0 to 100, otherwise both go
+// from 0 to 2^LEDZ_BRIGHTNESS_BITS - 1 (supported values: 8, 12 and 16). The curves tables
+// of the chosen resolution are generated by the Makefile when the macro is set in CONFIG,
+// e.g. make CONFIG=-DLEDZ_BRIGHTNESS_BITS=12, other build systems run tools/curves
+//#define LEDZ_BRIGHTNESS_BITS    12
+
+// enable/disable the selection of the brightness curve per LED (see ledz_curve)
+//#define LEDZ_CURVE_SUPPORT
+
+// enable/disable the fades with duration and easing (see ledz_fade_to)
+//#define LEDZ_EASING_SUPPORT
+
+// enable/disable the RGB and HSV colors of tricolor LEDs (see ledz_set_rgb)
+//#define LEDZ_RGB_SUPPORT
+
+// amount of colors converted at once by the batch functions, i.e. the size of the buffers
+// in the stack (6 bytes per color)
+#ifndef LEDZ_RGB_CHUNK
+#define LEDZ_RGB_CHUNK          16
+#endif
+
+// enable/disable the staggered internal PWM (optional)
+// the LEDs start the PWM with a phase offset according their instance, so the LEDs set at
+// the same time don't switch in the same ticks, and an edge which would exceed
+// LEDZ_PWM_MAX_EDGES in a tick is postponed to the next one, moving the phase of the LED.
+// This way the internal PWM writes at most LEDZ_PWM_MAX_EDGES LEDs per tick. A postponed
+// edge lengthens the current on or off time by one tick, which is not given back. While the
+// amount of LEDs using the internal PWM is up to LEDZ_PWM_MAX_EDGES * LEDZ_PWM_MAX / 2 the
+// phases settle where the edges fit and the period and duty cycle are kept. Over this load
+// the postponed edges accumulate, so the phase drifts and the period and duty cycle of the
+// LEDs change while the overload lasts
+//#define LEDZ_PWM_STAGGER
+
+// enable/disable the dithering of the internal PWM (optional)
+// the curves round the duty cycle to a whole tick, the rounding error is accumulated across
+// the PWM periods (first-order sigma-delta) and adds one tick to a period when it overflows.
+// The average duty cycle follows the curve in 1/256 of a tick, e.g. the lowest brightness
+// values turn the LED on for one tick every few periods instead of being off, which smooths
+// the fades at low brightness without a faster tick. Costs one byte per LED
+//#define LEDZ_DITHER_SUPPORT
+
+// maximum of LEDs switched by the internal PWM per tick when LEDZ_PWM_STAGGER is defined
+#ifndef LEDZ_PWM_MAX_EDGES
+#define LEDZ_PWM_MAX_EDGES      2
+#endif
+
+// enable/disable bit angle modulation (BAM) for the internal PWM (optional)
+// instead of a countdown per LED, the duty cycle is split in LEDZ_BAM_BITS bit planes
+// and the plane n is output during 2^n ticks, the LEDs are only updated in the plane
+// boundaries. In this case the PWM frequency is
+// 1 / (LEDZ_TICK_PERIOD * 1E-6 * (2^LEDZ_BAM_BITS - 1))
+//#define LEDZ_BAM_SUPPORT
+
+// amount of bit planes used by BAM
+#ifndef LEDZ_BAM_BITS
+#define LEDZ_BAM_BITS           8
+#endif
+
+// enable/disable the LED groups (see ledz_group_create)
+//#define LEDZ_GROUP_SUPPORT
+
+// enable/disable the keyframe player (see ledz_play), requires the brightness support
+//#define LEDZ_PLAYER_SUPPORT
+
+// maximum of sequences played at the same time
+#ifndef LEDZ_MAX_PLAYERS
+#define LEDZ_MAX_PLAYERS        4
+#endif
+
+// enable/disable the command queue (optional)
+// when defined, the functions which change the LED state (set, blink, brightness, fade...)
+// only enqueue a command which is applied at the start of the next tick, so the tick never
+// sees a half-applied change and the interrupts don't need to be disabled around the calls.
+// The queue is lock-free for a single producer (the API caller) and a single consumer (the
+// tick). When the queue is full the command is dropped and counted (see ledz_queue_dropped)
+// instead of waiting the tick, which would never return in the tick thread or in a caller
+// with higher priority. ledz_create, ledz_destroy, ledz_group_add and ledz_group_remove are
+// not queued and must not run concurrently with the tick. The commands of a destroyed LED are
+// dropped, even when a new LED takes its instances, through a generation byte per instance
+//#define LEDZ_COMMAND_QUEUE
+
+// enable/disable the framed mode (optional), requires LEDZ_COMMAND_QUEUE
+// the commands are kept in the queue until ledz_commit is called and the next tick applies
+// all of them together, writing the GPIO of each changed LED once, e.g. the three channels
+// of a RGB LED change in the same tick without intermediate colors. A frame bigger than
+// LEDZ_QUEUE_SIZE commands is split and ledz_commit returns an error, the commands written
+// while the queue is full are dropped
+//#define LEDZ_FRAMED_MODE
+
+// size of the command queue (must be a power of two)
+// each call of a LED function is a command, in the framed mode the queue must hold the calls
+// made between two commits, e.g. 18 to set the three channels of six RGB LEDs one by one
+#ifndef LEDZ_QUEUE_SIZE
+#ifdef LEDZ_FRAMED_MODE
+#define LEDZ_QUEUE_SIZE         64
+#else
+#define LEDZ_QUEUE_SIZE         16
+#endif
+#endif
 
-// tick period in us
+// enable/disable the contexts (see ledz_ctx_create)
+// each context owns a range of the LED instances and is ticked by its own timer, with its
+// own tick period and GPIO functions. The functions without the ctx prefix use the default
+// context, which holds the instances not taken by the other contexts
+//#define LEDZ_CONTEXT_SUPPORT
+
+// maximum of contexts created besides the default one
+#ifndef LEDZ_MAX_CONTEXTS
+#define LEDZ_MAX_CONTEXTS       1
+#endif
+
+// size in bytes of the CPU cache line (optional)
+// when defined the LED instances of each context start in a new cache line, so the
+// contexts ticked by different cores don't share cache lines (see ledz_shard.h)
+//#define LEDZ_CACHE_LINE         64
+
+// enable/disable the deadline heap of the tickless mode (see ledz_advance)
+// when defined, ledz_next_event_us and ledz_advance keep the LEDs with pending work in a
+// min-heap sorted by the tick of their next event, so each event only runs the LEDs due in
+// it instead of walking all active LEDs. The counters of the other LEDs are advanced when
+// they are due or changed by a function. It takes 12 bytes more per instance (14 from 255
+// instances on), the functions must not be called while ledz_advance runs, and the periodic
+// ledz_tick gives the LEDs back to the active set on its first call
+//#define LEDZ_DEADLINE_HEAP
+
+// enable/disable the statistics of the tick and of the GPIO writes (see ledz_stats_get)
+// the cost of each tick is measured with the LEDZ_STATS_CYCLES counter and the GPIO and
+// PWM writes are counted per LED
+//#define LEDZ_STATS_SUPPORT
+
+// configure the cycle counter used by the statistics, it must return an uint32_t counting
+// up, e.g. DWT->CYCCNT on Cortex-M or the nanoseconds of clock_gettime on a host
+//#define LEDZ_STATS_CYCLES()         (DWT->CYCCNT)
+
+// amount of counted cycles per microsecond, e.g. the CPU clock in MHz for DWT->CYCCNT
+// the ticks taking longer than the tick period are counted as overruns
+#ifndef LEDZ_STATS_CYCLES_PER_US
+#define LEDZ_STATS_CYCLES_PER_US    1
+#endif
+
+// tick period in us (of the default context)
+#ifndef LEDZ_TICK_PERIOD
 #define LEDZ_TICK_PERIOD        100
+#endif
+
+// brightness and duty cycle maximum values
+#ifdef LEDZ_BRIGHTNESS_BITS
+#define LEDZ_BRIGHTNESS_MAX     ((1 << LEDZ_BRIGHTNESS_BITS) - 1)
+#else
+#define LEDZ_BRIGHTNESS_MAX     100
+#endif
+#define LEDZ_PWM_MAX            LEDZ_BRIGHTNESS_MAX
 
 
 /*
@@ -92,12 +316,139 @@ extern "C"
  */
 typedef struct LEDZ_T ledz_t;
 
+/**
+ * @struct ledz_group_t
+ * An opaque structure representing a group of LEDs, it is also a led object
+ */
+typedef struct LEDZ_T ledz_group_t;
+
+/**
+ * @struct ledz_ctx_t
+ * An opaque structure representing a context, i.e. a set of LEDs updated by the same tick
+ */
+typedef struct LEDZ_CTX_T ledz_ctx_t;
+
+/**
+ * @struct ledz_handle_t
+ * A reference to a led object which detects the reuse of its instances, see ledz_handle
+ */
+typedef uint32_t ledz_handle_t;
+
+/**
+ * @struct ledz_gpio_t
+ * GPIO functions of a context, a NULL function uses the configured macro instead
+ *
+ * The arguments are the same of the LEDZ_GPIO_SET, LEDZ_GPIO_PWM and LEDZ_GPIO_WRITE_PORT
+ * macros, the pwm and write_port functions are only used when the respective macro is defined.
+ * A context with a set function and no write_port function doesn't group its pins by port, they
+ * are all written with its set function.
+ */
+typedef struct ledz_gpio_t {
+    void (*set)(int port, int pin, int value);
+    void (*pwm)(int port, int pin, int duty);
+    void (*write_port)(int port, uint32_t mask, uint32_t values);
+} ledz_gpio_t;
+
 /**
  * @struct ledz_type_t
  * LED types, i.e. how many LEDs are inside of the package
  */
 typedef enum ledz_type_t {LEDZ_1COLOR = 1, LEDZ_2COLOR, LEDZ_3COLOR} ledz_type_t;
 
+/**
+ * @struct ledz_duty_t
+ * Duty cycle type, wide enough to hold LEDZ_PWM_MAX
+ */
+#if LEDZ_PWM_MAX > 255
+typedef uint16_t ledz_duty_t;
+#else
+typedef unsigned char ledz_duty_t;
+#endif
+
+/**
+ * @struct ledz_curve_t
+ * Curves used to convert the brightness to duty cycle
+ */
+typedef enum ledz_curve_t {
+    LEDZ_CURVE_CIE1931,
+    LEDZ_CURVE_GAMMA,
+    LEDZ_CURVE_LINEAR,
+} ledz_curve_t;
+
+/**
+ * @struct ledz_easing_t
+ * Easing curves of ledz_fade_to, i.e. how the brightness moves along the fade duration
+ */
+typedef enum ledz_easing_t {
+    LEDZ_EASE_LINEAR,
+    LEDZ_EASE_IN,
+    LEDZ_EASE_OUT,
+    LEDZ_EASE_IN_OUT,
+    LEDZ_EASE_SINE,
+} ledz_easing_t;
+
+/**
+ * @struct ledz_rgb_t
+ * Color of a tricolor LED, each component from 0 to 255
+ */
+typedef struct ledz_rgb_t {
+    uint8_t red, green, blue;
+} ledz_rgb_t;
+
+/**
+ * @struct ledz_hsv_t
+ * Color of a tricolor LED in HSV, the hue goes from 0 to 65535 for a full turn (see LEDZ_HUE)
+ * and the saturation and value from 0 to 255
+ */
+typedef struct ledz_hsv_t {
+    uint16_t hue;
+    uint8_t saturation, value;
+} ledz_hsv_t;
+
+/**
+ * @struct ledz_stats_t
+ * Statistics of the tick in cycles of LEDZ_STATS_CYCLES, see ledz_stats_get
+ */
+typedef struct ledz_stats_t {
+    uint32_t ticks, overruns;
+    uint32_t cycles_min, cycles_avg, cycles_max;
+
+    // the bucket n counts the ticks which took from 2^n to 2^(n+1) - 1 cycles
+    uint32_t histogram[32];
+} ledz_stats_t;
+
+/**
+ * @struct ledz_led_stats_t
+ * GPIO and PWM writes of a LED, see ledz_stats_led
+ */
+typedef struct ledz_led_stats_t {
+    uint32_t gpio_writes, pwm_writes;
+} ledz_led_stats_t;
+
+/**
+ * @struct ledz_interpolation_t
+ * How a keyframe reaches its brightness
+ */
+typedef enum ledz_interpolation_t {
+    LEDZ_STEP,
+    LEDZ_LINEAR,
+} ledz_interpolation_t;
+
+/**
+ * @struct ledz_keyframe_t
+ * Keyframe of a sequence played by ledz_play
+ *
+ * The colors in the mask go to the brightness value, immediately (LEDZ_STEP) or ramping
+ * from the current brightness (LEDZ_LINEAR), and the next keyframe starts after the
+ * duration in milliseconds.
+ */
+typedef struct ledz_keyframe_t {
+    uint8_t color;
+    uint16_t brightness;
+    uint16_t duration;
+    uint8_t interpolation;
+} ledz_keyframe_t;
+
 /**
  * @struct ledz_color_t
  * LED colors
@@ -126,6 +477,57 @@ typedef enum ledz_color_t {
  * @{
  */
 
+/**
+ * Place the LED instances in the arena
+ *
+ * The arena is a buffer which holds the LED instances, ledz_instance_size returns the
+ * bytes of each instance. This function must be called once, before any other function
+ * of the library, and the arena must be kept while the library is used.
+ * This function requires LEDZ_ARENA_SUPPORT to be defined.
+ *
+ * @param[in] arena buffer of the instances, aligned by the function if needed
+ * @param[in] bytes size of the buffer
+ *
+ * @return amount of instances placed in the arena, up to LEDZ_MAX_INSTANCES, or zero if the
+ * arena is too small or ledz_init was already called
+ */
+unsigned int ledz_init(void *arena, size_t bytes);
+
+/**
+ * Get the bytes used by each LED instance in the arena
+ *
+ * This function requires LEDZ_ARENA_SUPPORT to be defined.
+ *
+ * @return size of one instance in bytes
+ */
+size_t ledz_instance_size(void);
+
+/**
+ * Get the handle of a led object
+ *
+ * The handle holds the instance and the generation of the object. Unlike the pointer, a
+ * handle kept after ledz_destroy is detected by ledz_resolve, even when the instances were
+ * taken by a new object. The generation has 8 bits, so a handle is only detected as stale
+ * while its instance was reused less than 256 times.
+ * This function requires LEDZ_ARENA_SUPPORT to be defined.
+ *
+ * @param[in] led ledz object pointer
+ *
+ * @return handle of the object or zero if led is NULL
+ */
+ledz_handle_t ledz_handle(ledz_t *led);
+
+/**
+ * Get the led object of a handle
+ *
+ * This function requires LEDZ_ARENA_SUPPORT to be defined.
+ *
+ * @param[in] handle handle returned by ledz_handle
+ *
+ * @return ledz object pointer or NULL if the object was destroyed
+ */
+ledz_t* ledz_resolve(ledz_handle_t handle);
+
 /**
  * Create ledz object
  *
@@ -133,7 +535,10 @@ typedef enum ledz_color_t {
  * it must be one of the values defined by ledz_type_t enumeration. The second
  * argument must be an array containing the color(s) of the LED being created.
  * The third argument must be an integer array of the port and pin of each LED
- * in correspondence with the previous color(s).
+ * in correspondence with the previous color(s). The port and pin values are copied
+ * to the ledz object, the port must be between 0 and 255 and the pin between 0 and 65535.
+ * The LEDs of the object take any free instances and the object keeps a table with the
+ * instance of each color, so the functions reach each color without walking a list.
  *
  * Examples:
  *      \code{.c}
@@ -150,13 +555,26 @@ typedef enum ledz_color_t {
  * @param[in] colors its a ledz_color_t type array containing the LED colors
  * @param[in] pins an integer array of the port and pin of each LED
  *
- * @return pointer to ledz object or NULL if no more led is available
+ * With LEDZ_ARENA_SUPPORT the object takes the last destroyed instances first and then the
+ * never used ones. Any destroyed instance is reused, e.g. a RGB LED takes the instances of
+ * three destroyed 1 color LEDs.
+ *
+ * The object is created right away, even with LEDZ_COMMAND_QUEUE, and its instances might
+ * be in the active set of the tick since a previous destroy, so it must not be created while
+ * the tick runs, e.g. disable the tick interrupt around the call.
+ *
+ * @return pointer to ledz object or NULL if no more led is available or a port or pin is
+ *         out of range
  */
 ledz_t* ledz_create(ledz_type_t type, const ledz_color_t *colors, const int *pins);
 
 /**
  * Destroy ledz_t object
  *
+ * With LEDZ_ARENA_SUPPORT an object already destroyed is ignored. The object is released
+ * right away, even with LEDZ_COMMAND_QUEUE, so it must not be destroyed while the tick
+ * runs, e.g. disable the tick interrupt around the call.
+ *
  * @param[in] led ledz object pointer
  */
 void ledz_destroy(ledz_t* led);
@@ -228,10 +646,25 @@ void ledz_blink(ledz_t* led, ledz_color_t color, uint16_t time_on, uint16_t time
  *
  * @param[in] led ledz object pointer
  * @param[in] color the color to adjust
- * @param[in] value the brightness value from 0 to 100
+ * @param[in] value the brightness value from 0 to LEDZ_BRIGHTNESS_MAX (100 by default)
  */
 void ledz_brightness(ledz_t* led, ledz_color_t color, unsigned int value);
 
+/**
+ * Set LED brightness curve
+ *
+ * Colors can be combinated using the OR operator.
+ *
+ * Selects the curve used to convert the brightness value to duty cycle. The default
+ * curve is CIE 1931, which compensates the non-linear perception of the human eye.
+ * This function requires LEDZ_CURVE_SUPPORT to be defined.
+ *
+ * @param[in] led ledz object pointer
+ * @param[in] color the color to adjust
+ * @param[in] curve one of the values in ledz_curve_t declaration
+ */
+void ledz_curve(ledz_t* led, ledz_color_t color, ledz_curve_t curve);
+
 /**
  * Fade in LED brightness
  *
@@ -264,6 +697,191 @@ void ledz_fade_in(ledz_t* led, ledz_color_t color, unsigned int rate, unsigned i
  */
 void ledz_fade_out(ledz_t* led, ledz_color_t color, unsigned int rate, unsigned int min);
 
+/**
+ * Fade LED brightness to a target
+ *
+ * Colors can be combinated using the OR operator.
+ *
+ * Moves the brightness from the current value to the target in the given duration,
+ * regardless of the distance, following the easing curve: constant speed (LEDZ_EASE_LINEAR),
+ * accelerating (LEDZ_EASE_IN), decelerating (LEDZ_EASE_OUT), both (LEDZ_EASE_IN_OUT) or a
+ * half cosine (LEDZ_EASE_SINE). The brightness is updated every millisecond, so short fades
+ * can change it by several units at once. A new fade, ledz_fade_in, ledz_fade_out or
+ * ledz_set stops the previous fade. This function requires LEDZ_EASING_SUPPORT to be defined.
+ *
+ * @param[in] led ledz object pointer
+ * @param[in] color the color to adjust
+ * @param[in] target the brightness at the end of the fade
+ * @param[in] duration the fade duration in milliseconds, zero sets the target immediately
+ * @param[in] easing one of the values in ledz_easing_t declaration
+ */
+void ledz_fade_to(ledz_t* led, ledz_color_t color, unsigned int target, uint16_t duration,
+                  ledz_easing_t easing);
+
+/**
+ * Set the white balance of the RGB colors
+ *
+ * Scales the red, green and blue components of the colors set by ledz_set_rgb and
+ * ledz_set_hsv, e.g. to compensate a green channel brighter than the others. The default
+ * is 255 for all components, i.e. no correction. The gamma correction is done by the curve
+ * of each channel (see ledz_curve). This function requires LEDZ_RGB_SUPPORT to be defined.
+ *
+ * @param[in] red the scale of the red component from 0 to 255
+ * @param[in] green the scale of the green component from 0 to 255
+ * @param[in] blue the scale of the blue component from 0 to 255
+ */
+void ledz_rgb_balance(uint8_t red, uint8_t green, uint8_t blue);
+
+/**
+ * Set LED color
+ *
+ * Sets the brightness of the LEDZ_RED, LEDZ_GREEN and LEDZ_BLUE LEDs of the object at once,
+ * walking its LEDs a single time. The components go from 0 to 255 and are scaled to
+ * LEDZ_BRIGHTNESS_MAX after the white balance (see ledz_rgb_balance). Like ledz_brightness,
+ * it stops a ledz_fade_to. This function requires LEDZ_RGB_SUPPORT to be defined.
+ *
+ * @param[in] led ledz object pointer
+ * @param[in] red the red component
+ * @param[in] green the green component
+ * @param[in] blue the blue component
+ */
+void ledz_set_rgb(ledz_t* led, uint8_t red, uint8_t green, uint8_t blue);
+
+/**
+ * Set LED color in HSV
+ *
+ * Same as ledz_set_rgb, the color is converted to RGB using integer arithmetic.
+ * This function requires LEDZ_RGB_SUPPORT to be defined.
+ *
+ * @param[in] led ledz object pointer
+ * @param[in] hue the hue from 0 to 65535 for a full turn (see LEDZ_HUE)
+ * @param[in] saturation the saturation from 0 to 255
+ * @param[in] value the value from 0 to 255
+ */
+void ledz_set_hsv(ledz_t* led, uint16_t hue, uint8_t saturation, uint8_t value);
+
+/**
+ * Set the color of several LEDs
+ *
+ * Same as calling ledz_set_rgb for each LED, but the colors are converted in chunks of
+ * LEDZ_RGB_CHUNK with loops that the compiler can vectorize.
+ * This function requires LEDZ_RGB_SUPPORT to be defined.
+ *
+ * @param[in] leds the ledz objects pointers
+ * @param[in] colors the colors, one per LED
+ * @param[in] count the amount of LEDs
+ */
+void ledz_set_rgb_batch(ledz_t* const *leds, const ledz_rgb_t *colors, unsigned int count);
+
+/**
+ * Set the color of several LEDs in HSV
+ *
+ * Same as calling ledz_set_hsv for each LED, but the colors are converted in chunks of
+ * LEDZ_RGB_CHUNK with loops that the compiler can vectorize.
+ * This function requires LEDZ_RGB_SUPPORT to be defined.
+ *
+ * @param[in] leds the ledz objects pointers
+ * @param[in] colors the colors, one per LED
+ * @param[in] count the amount of LEDs
+ */
+void ledz_set_hsv_batch(ledz_t* const *leds, const ledz_hsv_t *colors, unsigned int count);
+
+/**
+ * Play a keyframe sequence
+ *
+ * The sequence is executed by the tick without further calls from the application.
+ * It is not copied, so it must remain valid while playing, e.g. a const array in flash.
+ * Starting a new sequence replaces the one being played by the LED and a count of zero
+ * stops it, keeping the current brightness. The LEDs keep the brightness of the last
+ * keyframe when the sequence ends.
+ *
+ * The linear ramps use the fade control, so they are limited to one brightness unit per
+ * millisecond and the keyframe brightness is set when its duration ends. Up to
+ * LEDZ_MAX_PLAYERS sequences can be played at the same time, further calls are ignored.
+ * This function requires LEDZ_PLAYER_SUPPORT to be defined.
+ *
+ * @param[in] led ledz object pointer
+ * @param[in] seq the keyframes array
+ * @param[in] count the number of keyframes
+ * @param[in] repeat how many times the sequence is played, zero plays it forever
+ */
+void ledz_play(ledz_t* led, const ledz_keyframe_t *seq, unsigned int count, unsigned int repeat);
+
+/**
+ * Create a LED group
+ *
+ * A group takes one LED instance which owns the blink, fade and PWM counters of all its
+ * members, so the members are kept in phase and the tick updates the group only once.
+ * The group is controlled by the functions of the led objects (ledz_on, ledz_blink,
+ * ledz_fade_in...) passing the group as the led object, in this case the color argument
+ * is ignored. This function requires LEDZ_GROUP_SUPPORT to be defined.
+ *
+ * @return pointer to the group or NULL if no more led is available
+ */
+ledz_group_t* ledz_group_create(void);
+
+/**
+ * Destroy a LED group
+ *
+ * The members are removed from the group keeping their current state.
+ *
+ * @param[in] group the group pointer
+ */
+void ledz_group_destroy(ledz_group_t* group);
+
+/**
+ * Add LEDs to a group
+ *
+ * Colors can be combinated using the OR operator.
+ *
+ * The LEDs of the object with the given colors follow the group state from now on and
+ * must not be controlled individually while they are members. A LED can only be member
+ * of one group, the LEDs which are already members are ignored. This function and
+ * ledz_group_remove are not synchronized with the tick, not even by the command queue.
+ *
+ * @param[in] group the group pointer
+ * @param[in] led ledz object pointer
+ * @param[in] color the colors to add
+ */
+void ledz_group_add(ledz_group_t* group, ledz_t* led, ledz_color_t color);
+
+/**
+ * Remove LEDs from a group
+ *
+ * Colors can be combinated using the OR operator.
+ *
+ * @param[in] group the group pointer
+ * @param[in] led ledz object pointer
+ * @param[in] color the colors to remove
+ */
+void ledz_group_remove(ledz_group_t* group, ledz_t* led, ledz_color_t color);
+
+/**
+ * Commit the frame
+ *
+ * Publishes the commands issued since the last commit, which are applied together by the
+ * next tick. Only the LEDs whose state changed are written to the GPIO, once, with the
+ * final state of the frame. This function requires LEDZ_FRAMED_MODE to be defined.
+ *
+ * @return zero on success or -1 if the frame had more than LEDZ_QUEUE_SIZE commands, in this
+ * case the frame was split and its first commands were applied by the ticks before the commit,
+ * the commands written before the tick applied them were dropped (see ledz_queue_dropped)
+ */
+int ledz_commit(void);
+
+/**
+ * Get the amount of commands dropped by the queue
+ *
+ * A LED function called while the queue is full drops its command instead of waiting the
+ * tick to free a slot, so the calls never block, even from the thread which calls the tick.
+ * The counter only grows, a caller which must not lose a command compares it before and
+ * after the call and tries again after the next tick. This function requires
+ * LEDZ_COMMAND_QUEUE to be defined.
+ *
+ * @return the amount of commands dropped since the start
+ */
+unsigned int ledz_queue_dropped(void);
+
 /**
  * The tick function
  *
@@ -273,6 +891,220 @@ void ledz_fade_out(ledz_t* led, ledz_color_t color, unsigned int rate, unsigned
  */
 void ledz_tick(void);
 
+/**
+ * Get the time until the next LED state change
+ *
+ * This function is used by the tickless mode. Instead of calling ledz_tick from a
+ * periodic ISR, the application can program a one-shot timer with the returned time,
+ * sleep, and then call ledz_advance with the time actually elapsed.
+ *
+ * Note that the internal PWM changes the LED state on every edge, so the low-power
+ * sleep is only effective when blinking and fading or when LEDZ_GPIO_PWM is defined.
+ *
+ * @return the time in microseconds or LEDZ_NO_EVENT if no LED has pending work
+ */
+uint32_t ledz_next_event_us(void);
+
+/**
+ * Advance the ledz core time
+ *
+ * Runs all the LED state changes scheduled within the elapsed time. The time is
+ * converted to ticks of LEDZ_TICK_PERIOD, the remainder is kept for the next call.
+ * The ticks without state changes are skipped in a single step, so the cost of this
+ * function depends on the number of events and not on the elapsed time. Each event walks
+ * the active LEDs a few times to find the next one and run its tick, the cost of a few
+ * ticks, but the blink and fade events happen at most once per millisecond, while the
+ * periodic tick runs every LEDZ_TICK_PERIOD. With LEDZ_DEADLINE_HEAP each event only runs
+ * the LEDs due in it, taking O(log n) per LED in a heap of the n active LEDs.
+ *
+ * @param[in] elapsed_us the time in microseconds elapsed since the last call
+ */
+void ledz_advance(uint32_t elapsed_us);
+
+/**
+ * Get the statistics of the tick
+ *
+ * Copies the cost of the ticks measured since the start or the last ledz_stats_reset:
+ * minimum, average and maximum cycles, a histogram in powers of two and the amount of
+ * overruns, i.e. ticks taking longer than LEDZ_TICK_PERIOD. In the tickless mode only the
+ * ticks run by ledz_advance are measured, the skipped ones are not counted. If called while
+ * the tick is running, the values might belong to different ticks. This function requires
+ * LEDZ_STATS_SUPPORT to be defined.
+ *
+ * @param[out] stats the statistics
+ */
+void ledz_stats_get(ledz_stats_t *stats);
+
+/**
+ * Get the GPIO writes of a LED
+ *
+ * Sums the GPIO and PWM writes made by the LEDs of the given color(s), useful to find the
+ * LEDs which toggle the most, e.g. behind a port expander. A write grouped by
+ * LEDZ_GPIO_WRITE_PORT is counted for each LED. This function requires LEDZ_STATS_SUPPORT
+ * to be defined.
+ *
+ * @param[in] led ledz object pointer
+ * @param[in] color the color(s) of the LED
+ * @param[out] stats the amount of writes
+ */
+void ledz_stats_led(ledz_t* led, ledz_color_t color, ledz_led_stats_t *stats);
+
+/**
+ * Reset the statistics
+ *
+ * Clears the tick statistics and the write counters of the LEDs of the default context.
+ * This function requires LEDZ_STATS_SUPPORT to be defined.
+ */
+void ledz_stats_reset(void);
+
+/**
+ * Create a context
+ *
+ * The instances of the context are taken from the end of the default context, so the
+ * contexts must be created before the LEDs. The LEDs and groups of the context are
+ * created by ledz_ctx_led_create and ledz_ctx_group_create, controlled by the usual
+ * functions and updated by ledz_ctx_tick, or by ledz_ctx_next_event_us and
+ * ledz_ctx_advance in tickless mode. A group only accepts members of its own context.
+ * Each context can be ticked from a different timer or core since the contexts share no
+ * data, as long as the functions of the same context are not called concurrently (see
+ * the LEDZ_COMMAND_QUEUE macro). This function requires LEDZ_CONTEXT_SUPPORT to be defined.
+ *
+ * Example:
+ *      \code{.c}
+ *      // backlight LEDs ticked at 20 kHz by their own timer and GPIO function
+ *      ledz_ctx_t *fast = ledz_ctx_create(2, 50, &(ledz_gpio_t){.set = backlight_set});
+ *      ledz_t *backlight = ledz_ctx_led_create(fast, LEDZ_2COLOR, colors, pins);
+ *
+ *      // timer ISR of 50 us
+ *      ledz_ctx_tick(fast);
+ *      \endcode
+ *
+ * @param[in] instances the amount of LED instances owned by the context
+ * @param[in] tick_period the period in microseconds of ledz_ctx_tick (from 1 to 1000)
+ * @param[in] gpio the GPIO functions of the context or NULL to use the configured macros
+ *
+ * @return pointer to the context or NULL if the instances or contexts are not available
+ */
+ledz_ctx_t* ledz_ctx_create(unsigned int instances, unsigned int tick_period,
+                            const ledz_gpio_t *gpio);
+
+/**
+ * Destroy a context
+ *
+ * The instances of the context are given back to the end of the default context, so only
+ * the last created context can be destroyed, after its LEDs and groups. It must not be
+ * ticked anymore. This function requires LEDZ_CONTEXT_SUPPORT to be defined.
+ *
+ * @param[in] ctx the context pointer
+ *
+ * @return zero on success or -1 if the context is not the last created one or still has
+ *         LEDs
+ */
+int ledz_ctx_destroy(ledz_ctx_t* ctx);
+
+/**
+ * Create ledz object in a context
+ *
+ * Same as ledz_create using the instances of the given context.
+ *
+ * @param[in] ctx the context pointer
+ * @param[in] type must one of the values in ledz_type_t declaration
+ * @param[in] colors its a ledz_color_t type array containing the LED colors
+ * @param[in] pins an integer array of the port and pin of each LED
+ *
+ * @return pointer to ledz object or NULL if no more led is available in the context
+ */
+ledz_t* ledz_ctx_led_create(ledz_ctx_t* ctx, ledz_type_t type, const ledz_color_t *colors,
+                            const int *pins);
+
+/**
+ * Create a LED group in a context
+ *
+ * Same as ledz_group_create using the instances of the given context.
+ * This function requires LEDZ_GROUP_SUPPORT to be defined.
+ *
+ * @param[in] ctx the context pointer
+ *
+ * @return pointer to the group or NULL if no more led is available in the context
+ */
+ledz_group_t* ledz_ctx_group_create(ledz_ctx_t* ctx);
+
+/**
+ * The tick function of a context
+ *
+ * Same as ledz_tick for the LEDs of the given context. The period of the interruption
+ * must match the tick period of the context.
+ *
+ * @param[in] ctx the context pointer
+ */
+void ledz_ctx_tick(ledz_ctx_t* ctx);
+
+/**
+ * Get the time until the next LED state change of a context
+ *
+ * Same as ledz_next_event_us for the LEDs of the given context.
+ *
+ * @param[in] ctx the context pointer
+ *
+ * @return the time in microseconds or LEDZ_NO_EVENT if no LED has pending work
+ */
+uint32_t ledz_ctx_next_event_us(ledz_ctx_t* ctx);
+
+/**
+ * Advance the time of a context
+ *
+ * Same as ledz_advance for the LEDs of the given context.
+ *
+ * @param[in] ctx the context pointer
+ * @param[in] elapsed_us the time in microseconds elapsed since the last call
+ */
+void ledz_ctx_advance(ledz_ctx_t* ctx, uint32_t elapsed_us);
+
+/**
+ * Commit the frame of a context
+ *
+ * Same as ledz_commit for the LEDs of the given context. This function requires
+ * LEDZ_FRAMED_MODE to be defined.
+ *
+ * @param[in] ctx the context pointer
+ *
+ * @return zero on success or -1 if the frame was split (see ledz_commit)
+ */
+int ledz_ctx_commit(ledz_ctx_t* ctx);
+
+/**
+ * Get the amount of commands dropped by the queue of a context
+ *
+ * Same as ledz_queue_dropped for the queue of the given context. This function requires
+ * LEDZ_COMMAND_QUEUE to be defined.
+ *
+ * @param[in] ctx the context pointer
+ *
+ * @return the amount of commands dropped since the start
+ */
+unsigned int ledz_ctx_queue_dropped(ledz_ctx_t* ctx);
+
+/**
+ * Get the statistics of the tick of a context
+ *
+ * Same as ledz_stats_get for ledz_ctx_tick, the overruns are counted against the tick
+ * period of the context. This function requires LEDZ_STATS_SUPPORT to be defined.
+ *
+ * @param[in] ctx the context pointer
+ * @param[out] stats the statistics
+ */
+void ledz_ctx_stats_get(ledz_ctx_t* ctx, ledz_stats_t *stats);
+
+/**
+ * Reset the statistics of a context
+ *
+ * Same as ledz_stats_reset for the given context. This function requires
+ * LEDZ_STATS_SUPPORT to be defined.
+ *
+ * @param[in] ctx the context pointer
+ */
+void ledz_ctx_stats_reset(ledz_ctx_t* ctx);
+
 /**
  * @}
  */
@@ -288,10 +1120,85 @@ void ledz_tick(void);
 #error "LEDZ_GPIO_SET macro must defined"
 #endif
 
+#if LEDZ_MAX_INSTANCES <= 0 || LEDZ_MAX_INSTANCES >= 0xFFFF
+#error "LEDZ_MAX_INSTANCES macro value must be set between 1 and 65534"
+#endif
+
 #if LEDZ_TURN_ON_VALUE < 0 || LEDZ_TURN_ON_VALUE > 1
 #error "LEDZ_TURN_ON_VALUE must be set to 0 or 1"
 #endif
 
+#if defined(LEDZ_GPIO_WRITE_PORT) && LEDZ_MAX_PORTS <= 0
+#error "LEDZ_MAX_PORTS must be greater than zero"
+#endif
+
+#if defined(LEDZ_BRIGHTNESS_BITS) && \
+    LEDZ_BRIGHTNESS_BITS != 8 && LEDZ_BRIGHTNESS_BITS != 12 && LEDZ_BRIGHTNESS_BITS != 16
+#error "LEDZ_BRIGHTNESS_BITS macro value must be set to 8, 12 or 16"
+#endif
+
+#if defined(LEDZ_BAM_SUPPORT) && defined(LEDZ_GPIO_PWM)
+#error "LEDZ_BAM_SUPPORT is only used by the internal PWM, LEDZ_GPIO_PWM must not be defined"
+#endif
+
+#if defined(LEDZ_BAM_SUPPORT) && (LEDZ_BAM_BITS < 1 || LEDZ_BAM_BITS > 16)
+#error "LEDZ_BAM_BITS macro value must be set between 1 and 16"
+#endif
+
+#if defined(LEDZ_PWM_STAGGER) && (defined(LEDZ_GPIO_PWM) || defined(LEDZ_BAM_SUPPORT))
+#error "LEDZ_PWM_STAGGER is only used by the internal PWM without BAM"
+#endif
+
+#if defined(LEDZ_PWM_STAGGER) && LEDZ_PWM_MAX_EDGES <= 0
+#error "LEDZ_PWM_MAX_EDGES must be greater than zero"
+#endif
+
+#if defined(LEDZ_DITHER_SUPPORT) && \
+    (!defined(LEDZ_BRIGHTNESS_SUPPORT) || defined(LEDZ_GPIO_PWM) || defined(LEDZ_BAM_SUPPORT))
+#error "LEDZ_DITHER_SUPPORT is only used by the internal PWM without BAM"
+#endif
+
+#if defined(LEDZ_EASING_SUPPORT) && !defined(LEDZ_BRIGHTNESS_SUPPORT)
+#error "LEDZ_EASING_SUPPORT requires the brightness support"
+#endif
+
+#if defined(LEDZ_RGB_SUPPORT) && !defined(LEDZ_BRIGHTNESS_SUPPORT)
+#error "LEDZ_RGB_SUPPORT requires the brightness support"
+#endif
+
+#if defined(LEDZ_RGB_SUPPORT) && LEDZ_RGB_CHUNK <= 0
+#error "LEDZ_RGB_CHUNK must be greater than zero"
+#endif
+
+#if defined(LEDZ_PLAYER_SUPPORT) && !defined(LEDZ_BRIGHTNESS_SUPPORT)
+#error "LEDZ_PLAYER_SUPPORT requires the brightness support"
+#endif
+
+#if defined(LEDZ_PLAYER_SUPPORT) && LEDZ_MAX_PLAYERS <= 0
+#error "LEDZ_MAX_PLAYERS must be greater than zero"
+#endif
+
+#if defined(LEDZ_STATS_SUPPORT) && !defined(LEDZ_STATS_CYCLES)
+#error "LEDZ_STATS_SUPPORT requires the LEDZ_STATS_CYCLES macro to be defined"
+#endif
+
+#if defined(LEDZ_STATS_SUPPORT) && LEDZ_STATS_CYCLES_PER_US <= 0
+#error "LEDZ_STATS_CYCLES_PER_US must be greater than zero"
+#endif
+
+#if defined(LEDZ_FRAMED_MODE) && !defined(LEDZ_COMMAND_QUEUE)
+#error "LEDZ_FRAMED_MODE requires LEDZ_COMMAND_QUEUE to be defined"
+#endif
+
+#if defined(LEDZ_COMMAND_QUEUE) && \
+    (LEDZ_QUEUE_SIZE < 1 || (LEDZ_QUEUE_SIZE & (LEDZ_QUEUE_SIZE - 1)))
+#error "LEDZ_QUEUE_SIZE macro value must be a power of two"
+#endif
+
+#if defined(LEDZ_CONTEXT_SUPPORT) && (LEDZ_MAX_CONTEXTS < 1 || LEDZ_MAX_CONTEXTS > 254)
+#error "LEDZ_MAX_CONTEXTS macro value must be set between 1 and 254"
+#endif
+
 #if LEDZ_TICK_PERIOD <= 0 || LEDZ_TICK_PERIOD > 1000
 #error "LEDZ_TICK_PERIOD macro value must be set between 1 and 1000"
 #endif
@@ -0,0 +1,481 @@
+/*
+ * LEDZ - The LED Zeppelin
+ * https://github.com/ricardocrudo/ledz
+ *
+ * Copyright (c) 2017 Ricardo Crudo <ricardo.crudo@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LEDZ_HPP
+#define LEDZ_HPP
+
+/*
+****************************************************************************************************
+*       INCLUDE FILES
+****************************************************************************************************
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// the configuration macros are the defaults of ledz::Config
+#include "ledz.h"
+
+
+/*
+****************************************************************************************************
+*       DATA TYPES
+****************************************************************************************************
+*/
+
+namespace ledz {
+
+/**
+ * @defgroup ledz_cpp C++ Front-end
+ * Header-only LED pool specialized at compile time (requires C++17)
+ *
+ * The pins and the features of each LED are template parameters, so the tick of a
+ * ledz::Pool writes the GPIO with constant ports and pins and only has the code of the
+ * features used by each LED. The pool does not use ledz.c and behaves as the C library for
+ * single color LEDs, with the CIE 1931 curve and the internal or hardware PWM.
+ * @{
+ */
+
+/**
+ * Features of a LED, the code and the state of the features not used are compiled out
+ */
+enum : unsigned int {
+    BLINK       = 0x01,
+    BRIGHTNESS  = 0x02,
+    FADE        = 0x04,     // requires BRIGHTNESS
+    ALL         = BLINK | BRIGHTNESS | FADE,
+};
+
+/**
+ * Pin of a LED and its features
+ *
+ * @tparam Port the GPIO port
+ * @tparam Number the GPIO pin
+ * @tparam Features the features used by the LED, e.g. BLINK | BRIGHTNESS
+ */
+template <int Port, int Number, unsigned int Features = ALL>
+struct Pin {
+    static constexpr int port = Port;
+    static constexpr int pin = Number;
+    static constexpr unsigned int features = Features;
+
+    static_assert(!(Features & FADE) || (Features & BRIGHTNESS), "FADE requires BRIGHTNESS");
+};
+
+/**
+ * Configuration of a pool, the defaults are taken from the ledz.h macros
+ *
+ * A board derives from it and replaces the members as needed, e.g.:
+ *
+ *     struct Board : ledz::Config {
+ *         static constexpr unsigned int tick_period = 50;
+ *         static void set(int port, int pin, int value) { ... }
+ *     };
+ */
+struct Config {
+    static constexpr int turn_on_value = LEDZ_TURN_ON_VALUE;
+    static constexpr unsigned int tick_period = LEDZ_TICK_PERIOD;
+
+#ifdef LEDZ_GPIO_PWM
+    static constexpr bool hardware_pwm = true;
+#else
+    static constexpr bool hardware_pwm = false;
+#endif
+
+    static void set(int port, int pin, int value)
+    {
+        LEDZ_GPIO_SET(port, pin, value);
+    }
+
+    static void pwm(int port, int pin, int duty)
+    {
+#ifdef LEDZ_GPIO_PWM
+        LEDZ_GPIO_PWM(port, pin, duty);
+#else
+        (void) port;
+        (void) pin;
+        (void) duty;
+#endif
+    }
+};
+
+/**
+ * @}
+ */
+
+namespace detail {
+
+// brightness curve of the C library
+#ifdef LEDZ_BRIGHTNESS_BITS
+#include "ledz_curves_gen.h"
+#else
+#include "ledz_curves.h"
+#endif
+
+#if defined(LEDZ_BRIGHTNESS_BITS) ? LEDZ_CURVES_BITS != LEDZ_BRIGHTNESS_BITS : LEDZ_CURVES_BITS != 0
+#error "the curves do not match LEDZ_BRIGHTNESS_BITS, rebuild with LEDZ_BRIGHTNESS_BITS in CONFIG"
+#endif
+
+using level_t = std::conditional_t<(LEDZ_BRIGHTNESS_MAX > 0xFF), uint16_t, uint8_t>;
+
+template <int N>
+struct Empty {};
+
+struct BlinkState {
+    uint16_t time_on, time_off, time;
+    uint8_t blink, blink_state;
+};
+
+struct BrightnessState {
+    level_t brightness_value;
+    uint8_t brightness;
+};
+
+struct PwmState {
+    // internal PWM counter
+    level_t pwm;
+};
+
+struct FadeState {
+    uint16_t fade_in, fade_out, fade_counter;
+    level_t fade_min, fade_max;
+};
+
+// state of a led, with the fields of its features only
+template <unsigned int Features, bool HardwarePwm>
+struct State :
+    std::conditional_t<(Features & BLINK) != 0, BlinkState, Empty<0>>,
+    std::conditional_t<(Features & BRIGHTNESS) != 0, BrightnessState, Empty<1>>,
+    std::conditional_t<(Features & BRIGHTNESS) != 0 && !HardwarePwm, PwmState, Empty<2>>,
+    std::conditional_t<(Features & FADE) != 0, FadeState, Empty<3>>
+{
+    uint8_t state;
+};
+
+} // namespace detail
+
+
+/*
+****************************************************************************************************
+*       CLASSES
+****************************************************************************************************
+*/
+
+/**
+ * @ingroup ledz_cpp
+ * Pool of single color LEDs
+ *
+ * The LEDs are addressed by their index in the pins list, as template arguments, e.g.
+ * pool.blink<0>(100, 400). The functions have the same behavior of the C functions with
+ * the same name. The pool is zero initialized, all LEDs off.
+ *
+ * @tparam Conf the configuration, ledz::Config or a class derived from it
+ * @tparam Pins the pins of the LEDs, ledz::Pin types
+ */
+template <typename Conf, typename... Pins>
+class Pool
+{
+public:
+    /// amount of LEDs of the pool
+    static constexpr size_t size = sizeof...(Pins);
+
+    static_assert(size > 0, "the pool must have at least one LED");
+    static_assert(Conf::tick_period > 0 && Conf::tick_period <= 1000,
+                  "the tick period must be set between 1 and 1000");
+
+    /// Turn the LED on
+    template <size_t I>
+    void on() { set<I>(1); }
+
+    /// Turn the LED off
+    template <size_t I>
+    void off() { set<I>(0); }
+
+    /// Toggle the LED
+    template <size_t I>
+    void toggle() { set<I>(-1); }
+
+    /// Set the LED state, a negative value toggles it, disables blink and brightness control
+    template <size_t I>
+    void set(int value)
+    {
+        auto &led = std::get<I>(leds_);
+
+        if constexpr (features<I>() & BLINK)
+            led.blink = 0;
+
+        if constexpr (features<I>() & BRIGHTNESS)
+            led.brightness = 0;
+
+        if (value >= 1)
+            value = 1;
+
+        if (led.state == value)
+            return;
+
+        if (value < 0)
+            value = 1 - led.state;
+
+        write<I>(value);
+    }
+
+    /// Blink the LED with the times in milliseconds, a time of zero stops blinking
+    template <size_t I>
+    void blink(uint16_t time_on, uint16_t time_off)
+    {
+        static_assert(features<I>() & BLINK, "the LED has no BLINK feature");
+        auto &led = std::get<I>(leds_);
+
+        if (time_on == 0 || time_off == 0)
+        {
+            led.blink = 0;
+            return;
+        }
+
+        led.time_on = time_on;
+        led.time_off = time_off;
+        led.blink_state = led.state;
+        led.time = led.state ? time_on : time_off;
+        led.blink = 1;
+    }
+
+    /// Set the LED brightness from 0 to LEDZ_BRIGHTNESS_MAX
+    template <size_t I>
+    void brightness(unsigned int value)
+    {
+        static_assert(features<I>() & BRIGHTNESS, "the LED has no BRIGHTNESS feature");
+        auto &led = std::get<I>(leds_);
+
+        if (value >= LEDZ_BRIGHTNESS_MAX)
+            value = LEDZ_BRIGHTNESS_MAX;
+
+        unsigned int duty = detail::cie1931[value];
+
+        if (duty > 0 && duty < LEDZ_PWM_MAX)
+            pwm<I>(duty);
+        else
+            write<I>(duty > 0);
+
+        if constexpr (!Conf::hardware_pwm)
+            led.pwm = 0;
+
+        led.brightness_value = value;
+        led.brightness = 1;
+    }
+
+    /// Increase the brightness by one every rate milliseconds until max
+    template <size_t I>
+    void fade_in(unsigned int rate, unsigned int max)
+    {
+        static_assert(features<I>() & FADE, "the LED has no FADE feature");
+        auto &led = std::get<I>(leds_);
+
+        led.fade_in = rate > UINT16_MAX ? UINT16_MAX : rate;
+        led.fade_max = max > LEDZ_BRIGHTNESS_MAX ? LEDZ_BRIGHTNESS_MAX : max;
+
+        if (!led.brightness)
+        {
+            if constexpr (!Conf::hardware_pwm)
+                led.pwm = 0;
+
+            led.brightness_value = 0;
+            led.brightness = 1;
+        }
+    }
+
+    /// Decrease the brightness by one every rate milliseconds until min
+    template <size_t I>
+    void fade_out(unsigned int rate, unsigned int min)
+    {
+        static_assert(features<I>() & FADE, "the LED has no FADE feature");
+        auto &led = std::get<I>(leds_);
+
+        led.fade_out = rate > UINT16_MAX ? UINT16_MAX : rate;
+        led.fade_min = min > LEDZ_BRIGHTNESS_MAX ? LEDZ_BRIGHTNESS_MAX : min;
+    }
+
+    /// The tick function, must be called every Conf::tick_period microseconds
+    void tick()
+    {
+        bool flag_1ms = false;
+
+        if (++counter_1ms_ >= ticks_1ms)
+        {
+            counter_1ms_ = 0;
+            flag_1ms = true;
+        }
+
+        update(flag_1ms, std::index_sequence_for<Pins...>{});
+    }
+
+private:
+    // rounded amount of ticks in 1ms
+    static constexpr unsigned int ticks_1ms = (10000 / Conf::tick_period + 5) / 10;
+
+    template <size_t I>
+    using pin_t = std::tuple_element_t<I, std::tuple<Pins...>>;
+
+    template <size_t I>
+    static constexpr unsigned int features() { return pin_t<I>::features; }
+
+    template <size_t I>
+    void write(int value)
+    {
+        Conf::set(pin_t<I>::port, pin_t<I>::pin, !(Conf::turn_on_value ^ value));
+        std::get<I>(leds_).state = value;
+    }
+
+    template <size_t I>
+    void pwm(unsigned int duty)
+    {
+        if constexpr (Conf::hardware_pwm)
+            Conf::pwm(pin_t<I>::port, pin_t<I>::pin, duty);
+    }
+
+    template <size_t I>
+    unsigned int duty() const
+    {
+        return detail::cie1931[std::get<I>(leds_).brightness_value];
+    }
+
+    template <size_t... I>
+    void update(bool flag_1ms, std::index_sequence<I...>)
+    {
+        (update<I>(flag_1ms), ...);
+    }
+
+    // same as ledz_update of the C library, without the features not used by the led
+    template <size_t I>
+    void update(bool flag_1ms)
+    {
+        auto &led = std::get<I>(leds_);
+
+        if constexpr (features<I>() & BLINK)
+        {
+            if (led.blink && flag_1ms)
+            {
+                if (led.time > 0)
+                    led.time--;
+
+                if (led.time == 0)
+                {
+                    if (led.blink_state)
+                    {
+                        if constexpr (features<I>() & BRIGHTNESS)
+                            pwm<I>(0);
+
+                        write<I>(0);
+                        led.time = led.time_off;
+                    }
+                    else
+                    {
+                        write<I>(1);
+
+                        if constexpr (features<I>() & BRIGHTNESS)
+                            pwm<I>(duty<I>());
+
+                        led.time = led.time_on;
+                    }
+
+                    led.blink_state = 1 - led.blink_state;
+                    return;
+                }
+            }
+        }
+
+        if constexpr ((features<I>() & BRIGHTNESS) && !Conf::hardware_pwm)
+        {
+            bool blink_on = true;
+            if constexpr (features<I>() & BLINK)
+                blink_on = !led.blink || led.blink_state;
+
+            if (led.brightness && blink_on)
+            {
+                if (led.pwm > 0)
+                    led.pwm--;
+
+                if (led.pwm == 0)
+                {
+                    led.pwm = led.state ? LEDZ_PWM_MAX - duty<I>() : duty<I>();
+
+                    if (led.pwm > 0 && led.pwm < LEDZ_PWM_MAX)
+                    {
+                        write<I>(!led.state);
+                    }
+                    else if (led.pwm == LEDZ_PWM_MAX)
+                    {
+                        write<I>(!led.state);
+                        led.pwm = 0;
+                    }
+                }
+            }
+        }
+
+        if constexpr (features<I>() & FADE)
+        {
+            if (flag_1ms)
+            {
+                if (led.fade_in > 0 && led.brightness_value < led.fade_max)
+                {
+                    if (++led.fade_counter == led.fade_in)
+                    {
+                        led.brightness_value++;
+                        led.fade_counter = 0;
+                        pwm<I>(duty<I>());
+                    }
+                }
+                else
+                {
+                    led.fade_in = 0;
+                }
+
+                if (led.fade_out > 0 && led.brightness_value > led.fade_min)
+                {
+                    if (++led.fade_counter == led.fade_out)
+                    {
+                        led.brightness_value--;
+                        led.fade_counter = 0;
+                        pwm<I>(duty<I>());
+                    }
+                }
+                else
+                {
+                    led.fade_out = 0;
+                }
+            }
+        }
+    }
+
+    std::tuple<detail::State<Pins::features, Conf::hardware_pwm>...> leds_{};
+    uint16_t counter_1ms_ = 0;
+};
+
+} // namespace ledz
+
+// LEDZ_HPP
+#endif
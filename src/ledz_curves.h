@@ -0,0 +1,67 @@
+// generated by tools/curves, do not edit
+// the resolution is set by LEDZ_BRIGHTNESS_BITS (0 = legacy 0 to 100, 8, 12 or 16)
+// the tables are static, so the header can be included by several sources
+
+#define LEDZ_CURVES_BITS    0
+
+static const ledz_duty_t cie1931[101] = {
+      0,   0,   0,   0,   0,   1,   1,   1,   1,   1,
+      1,   1,   1,   2,   2,   2,   2,   2,   3,   3,
+      3,   3,   4,   4,   4,   4,   5,   5,   5,   6,
+      6,   7,   7,   8,   8,   8,   9,  10,  10,  11,
+     11,  12,  12,  13,  14,  15,  15,  16,  17,  18,
+     18,  19,  20,  21,  22,  23,  24,  25,  26,  27,
+     28,  29,  30,  32,  33,  34,  35,  37,  38,  39,
+     41,  42,  44,  45,  47,  48,  50,  52,  53,  55,
+     57,  58,  60,  62,  64,  66,  68,  70,  72,  74,
+     76,  78,  81,  83,  85,  88,  90,  92,  95,  97,
+    100,
+};
+
+#ifdef LEDZ_CURVE_SUPPORT
+static const ledz_duty_t gamma22[101] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+      1,   1,   1,   1,   1,   2,   2,   2,   2,   3,
+      3,   3,   4,   4,   4,   5,   5,   6,   6,   7,
+      7,   8,   8,   9,   9,  10,  11,  11,  12,  13,
+     13,  14,  15,  16,  16,  17,  18,  19,  20,  21,
+     22,  23,  24,  25,  26,  27,  28,  29,  30,  31,
+     33,  34,  35,  36,  37,  39,  40,  41,  43,  44,
+     46,  47,  49,  50,  52,  53,  55,  56,  58,  60,
+     61,  63,  65,  66,  68,  70,  72,  74,  75,  77,
+     79,  81,  83,  85,  87,  89,  91,  94,  96,  98,
+    100,
+};
+#endif
+
+#ifdef LEDZ_DITHER_SUPPORT
+static const int8_t cie1931_residual[101] = {
+       0,   28,   57,   85,  113, -114,  -86,  -57,  -29,    0,
+      32,   67,  104, -112,  -69,  -23,   25,   77, -123,  -65,
+      -3,   63, -124,  -51,   26,  106,  -65,   24,  117,  -41,
+      60,  -89,   22, -118,    2,  127,    2, -118,   23,  -87,
+      64,  -35,  127,   40,  -41, -117,   69,    5,  -53, -104,
+     107,   69,   37,   12,   -7,  -18,  -22,  -20,  -10,    7,
+      32,   64,  103, -106,  -51,   12,   83,  -94,   -7,   88,
+     -64,   48,  -87,   42,  -76,   71,  -29, -120,   54,  -18,
+     -82,  121,   76,   42,   17,    2,   -3,    2,   17,   42,
+      78,  124,  -76,   -8,   70,  -98,    2,  113,  -21,  112,
+       0,
+};
+
+#ifdef LEDZ_CURVE_SUPPORT
+static const int8_t gamma22_residual[101] = {
+       0,    1,    5,   11,   22,   35,   53,   74,   99, -128,
+     -94,  -57,  -15,   32,   83, -118,  -58,    7,   77, -105,
+     -26,   58, -109,  -15,   84,  -67,   42, -100,   20, -111,
+      19, -102,   39,  -71,   81,  -18, -111,   57,  -26, -103,
+      82,   17,  -43,  -98,  110,   67,   30,   -2,  -27,  -47,
+     -60,  -68,  -70,  -66,  -57,  -41,  -19,    9,   43,   83,
+    -127,  -75,  -17,   48,  118,  -61,   22,  111,  -49,   52,
+     -96,   19, -117,   10, -113,   27,  -83,   69,  -28, -119,
+      53,  -25,  -96,   95,   36,  -16,  -61, -100,  124,   99,
+      80,   67,   61,   62,   70,   84,  105, -123,  -89,  -48,
+       0,
+};
+#endif
+#endif
@@ -0,0 +1,325 @@
+/*
+ * LEDZ - The LED Zeppelin
+ * https://github.com/ricardocrudo/ledz
+ *
+ * Copyright (c) 2017 Ricardo Crudo <ricardo.crudo@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+****************************************************************************************************
+*       INCLUDE FILES
+****************************************************************************************************
+*/
+
+// required by the CPU affinity functions
+#define _GNU_SOURCE
+
+#include "ledz_linux.h"
+
+#ifdef LEDZ_LINUX_SUPPORT
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/timerfd.h>
+
+
+/*
+****************************************************************************************************
+*       INTERNAL GLOBAL VARIABLES
+****************************************************************************************************
+*/
+
+static ledz_backend_t g_backend;
+static int g_backend_set;
+
+// serializes the outputs of the tick thread and of the LED functions
+static pthread_mutex_t g_output_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_t g_thread;
+static int g_timer = -1;
+static int g_running;
+static unsigned int g_max_catchup;
+static uint64_t g_ticks, g_overruns;
+
+
+/*
+****************************************************************************************************
+*       INTERNAL FUNCTIONS
+****************************************************************************************************
+*/
+
+static void ledz_gpio_backend_set(void *data, int port, int pin, int value)
+{
+    (void) data;
+
+    gpio_set(port, pin, value);
+}
+
+#ifdef LEDZ_GPIO_PWM
+static void ledz_gpio_backend_pwm(void *data, int port, int pin, int duty)
+{
+    (void) data;
+
+    gpio_pwm(port, pin, duty);
+}
+#endif
+
+static void ledz_memory_store(ledz_memory_t *memory, int port, int pin, int value, int pwm)
+{
+    if (memory->count >= memory->size)
+    {
+        memory->dropped++;
+        return;
+    }
+
+    ledz_event_t *event = &memory->events[memory->count++];
+    event->tick = __atomic_load_n(&g_ticks, __ATOMIC_RELAXED);
+    event->port = port;
+    event->pin = pin;
+    event->value = value;
+    event->pwm = pwm;
+}
+
+static void ledz_memory_set(void *data, int port, int pin, int value)
+{
+    ledz_memory_store(data, port, pin, value, 0);
+}
+
+static void ledz_memory_pwm(void *data, int port, int pin, int duty)
+{
+    ledz_memory_store(data, port, pin, duty, 1);
+}
+
+static void ledz_file_write(int fd, const char *kind, int port, int pin, int value)
+{
+    char line[64];
+    int size = snprintf(line, sizeof(line), "%llu %s %d %d %d\n",
+                        (unsigned long long) __atomic_load_n(&g_ticks, __ATOMIC_RELAXED),
+                        kind, port, pin, value);
+
+    // a full pipe blocks the tick until the reader catches up
+    if (write(fd, line, size) != size)
+        return;
+}
+
+static void ledz_file_set(void *data, int port, int pin, int value)
+{
+    ledz_file_write((int) (intptr_t) data, "set", port, pin, value);
+}
+
+static void ledz_file_pwm(void *data, int port, int pin, int duty)
+{
+    ledz_file_write((int) (intptr_t) data, "pwm", port, pin, duty);
+}
+
+static void* ledz_linux_thread(void *arg)
+{
+    (void) arg;
+
+    while (__atomic_load_n(&g_running, __ATOMIC_ACQUIRE))
+    {
+        // amount of periods elapsed since the last read, more than one means missed ticks
+        uint64_t expirations;
+        if (read(g_timer, &expirations, sizeof(expirations)) != sizeof(expirations))
+            continue;
+
+        __atomic_fetch_add(&g_overruns, expirations - 1, __ATOMIC_RELAXED);
+
+        if (g_max_catchup && expirations > g_max_catchup)
+            expirations = g_max_catchup;
+
+        while (expirations--)
+        {
+            ledz_tick();
+            __atomic_fetch_add(&g_ticks, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    return 0;
+}
+
+
+/*
+****************************************************************************************************
+*       GLOBAL FUNCTIONS
+****************************************************************************************************
+*/
+
+void ledz_linux_output_set(int port, int pin, int value)
+{
+    pthread_mutex_lock(&g_output_lock);
+
+    const ledz_backend_t *backend = g_backend_set ? &g_backend : ledz_backend_gpio();
+    backend->set(backend->data, port, pin, value);
+
+    pthread_mutex_unlock(&g_output_lock);
+}
+
+void ledz_linux_output_pwm(int port, int pin, int duty)
+{
+    pthread_mutex_lock(&g_output_lock);
+
+    const ledz_backend_t *backend = g_backend_set ? &g_backend : ledz_backend_gpio();
+    if (backend->pwm)
+        backend->pwm(backend->data, port, pin, duty);
+
+    pthread_mutex_unlock(&g_output_lock);
+}
+
+int ledz_linux_start(const ledz_linux_config_t *config)
+{
+    static const ledz_linux_config_t defaults;
+
+    if (g_running)
+        return -1;
+
+    if (!config)
+        config = &defaults;
+
+    g_timer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (g_timer < 0)
+        return -1;
+
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+
+    int error = 0;
+    if (config->priority)
+    {
+        struct sched_param param = {.sched_priority = config->priority};
+        error |= pthread_attr_setinheritsched(&attributes, PTHREAD_EXPLICIT_SCHED);
+        error |= pthread_attr_setschedpolicy(&attributes, SCHED_FIFO);
+        error |= pthread_attr_setschedparam(&attributes, &param);
+    }
+
+    if (config->cpu_mask)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int i = 0; i < 32; i++)
+        {
+            if (config->cpu_mask & (1u << i))
+                CPU_SET(i, &cpus);
+        }
+
+        error |= pthread_attr_setaffinity_np(&attributes, sizeof(cpus), &cpus);
+    }
+
+    // the first deadline is one period from now, the next ones are multiples of the period
+    // from it, so the time spent by the ticks doesn't accumulate
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    struct itimerspec deadline;
+    deadline.it_interval.tv_sec = LEDZ_TICK_PERIOD / 1000000;
+    deadline.it_interval.tv_nsec = (LEDZ_TICK_PERIOD % 1000000) * 1000;
+    deadline.it_value.tv_sec = now.tv_sec + deadline.it_interval.tv_sec;
+    deadline.it_value.tv_nsec = now.tv_nsec + deadline.it_interval.tv_nsec;
+    if (deadline.it_value.tv_nsec >= 1000000000)
+    {
+        deadline.it_value.tv_sec++;
+        deadline.it_value.tv_nsec -= 1000000000;
+    }
+
+    error |= timerfd_settime(g_timer, TFD_TIMER_ABSTIME, &deadline, NULL);
+
+    pthread_mutex_lock(&g_output_lock);
+    g_backend = config->backend ? *config->backend : *ledz_backend_gpio();
+    g_backend_set = 1;
+    pthread_mutex_unlock(&g_output_lock);
+
+    g_max_catchup = config->max_catchup;
+    g_ticks = 0;
+    g_overruns = 0;
+    g_running = 1;
+
+    if (error || pthread_create(&g_thread, &attributes, ledz_linux_thread, 0))
+    {
+        g_running = 0;
+        g_backend_set = 0;
+        close(g_timer);
+        g_timer = -1;
+        error = 1;
+    }
+
+    pthread_attr_destroy(&attributes);
+
+    return error ? -1 : 0;
+}
+
+void ledz_linux_stop(void)
+{
+    if (!g_running)
+        return;
+
+    // the thread checks the flag when the timer expires
+    __atomic_store_n(&g_running, 0, __ATOMIC_RELEASE);
+    pthread_join(g_thread, NULL);
+
+    close(g_timer);
+    g_timer = -1;
+
+    pthread_mutex_lock(&g_output_lock);
+    g_backend_set = 0;
+    pthread_mutex_unlock(&g_output_lock);
+}
+
+uint64_t ledz_linux_ticks(void)
+{
+    return __atomic_load_n(&g_ticks, __ATOMIC_RELAXED);
+}
+
+uint64_t ledz_linux_overruns(void)
+{
+    return __atomic_load_n(&g_overruns, __ATOMIC_RELAXED);
+}
+
+const ledz_backend_t* ledz_backend_gpio(void)
+{
+    static const ledz_backend_t backend = {
+        .set = ledz_gpio_backend_set,
+#ifdef LEDZ_GPIO_PWM
+        .pwm = ledz_gpio_backend_pwm,
+#endif
+    };
+
+    return &backend;
+}
+
+void ledz_backend_memory(ledz_backend_t *backend, ledz_memory_t *memory)
+{
+    backend->set = ledz_memory_set;
+    backend->pwm = ledz_memory_pwm;
+    backend->data = memory;
+}
+
+void ledz_backend_file(ledz_backend_t *backend, int fd)
+{
+    backend->set = ledz_file_set;
+    backend->pwm = ledz_file_pwm;
+    backend->data = (void *) (intptr_t) fd;
+}
+
+#endif
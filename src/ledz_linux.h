@@ -0,0 +1,194 @@
+/*
+ * LEDZ - The LED Zeppelin
+ * https://github.com/ricardocrudo/ledz
+ *
+ * Copyright (c) 2017 Ricardo Crudo <ricardo.crudo@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef LEDZ_LINUX_H
+#define LEDZ_LINUX_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+****************************************************************************************************
+*       INCLUDE FILES
+****************************************************************************************************
+*/
+
+#include <stdint.h>
+#include "ledz.h"
+
+
+/*
+****************************************************************************************************
+*       DATA TYPES
+****************************************************************************************************
+*/
+
+/**
+ * @struct ledz_backend_t
+ * Output backend of the Linux runtime, receives the GPIO changes of the library
+ *
+ * The data pointer is given back as the first argument of the functions. A NULL pwm
+ * function ignores the PWM changes, which only happen when LEDZ_GPIO_PWM is defined as
+ * ledz_linux_output_pwm.
+ */
+typedef struct ledz_backend_t {
+    void (*set)(void *data, int port, int pin, int value);
+    void (*pwm)(void *data, int port, int pin, int duty);
+    void *data;
+} ledz_backend_t;
+
+/**
+ * @struct ledz_event_t
+ * GPIO change stored by the memory backend
+ */
+typedef struct ledz_event_t {
+    uint64_t tick;
+    int port, pin, value;
+    uint8_t pwm;
+} ledz_event_t;
+
+/**
+ * @struct ledz_memory_t
+ * Buffer of the memory backend, the changes exceeding the size are counted as dropped
+ */
+typedef struct ledz_memory_t {
+    ledz_event_t *events;
+    unsigned int size, count, dropped;
+} ledz_memory_t;
+
+/**
+ * @struct ledz_linux_config_t
+ * Configuration of the Linux runtime, zero initialized fields use the defaults
+ */
+typedef struct ledz_linux_config_t {
+    // output backend, NULL to call the gpio_set function
+    const ledz_backend_t *backend;
+
+    // SCHED_FIFO priority of the tick thread, zero to keep the default scheduling
+    int priority;
+
+    // CPUs where the tick thread may run (bit n is the CPU n), zero to not pin the thread
+    uint32_t cpu_mask;
+
+    // maximum of ticks run per wake up, zero to catch up all missed ticks
+    unsigned int max_catchup;
+} ledz_linux_config_t;
+
+
+/*
+****************************************************************************************************
+*       FUNCTION PROTOTYPES
+****************************************************************************************************
+*/
+
+/**
+ * @defgroup ledz_linux_funcs Linux Runtime Functions
+ * Set of functions to run the library in Linux userspace
+ * @{
+ */
+
+/**
+ * Start the Linux runtime
+ *
+ * Creates the thread which calls ledz_tick every LEDZ_TICK_PERIOD. The thread sleeps in a
+ * timerfd armed with absolute deadlines, so the period doesn't drift with the tick duration.
+ * When the thread wakes up late (e.g. preempted), ledz_tick is called once per missed tick,
+ * keeping the LED timing in sync with the clock, up to max_catchup ticks per wake up.
+ * The GPIO changes made by the library, from the tick or from the LED functions, are given
+ * to the backend. This function requires LEDZ_LINUX_SUPPORT to be defined.
+ *
+ * @param[in] config the runtime configuration or NULL to use the defaults
+ *
+ * @return zero on success or -1 if the runtime is already running, the timer or the thread
+ * could not be created, or the priority or the CPU could not be set (e.g. no permission)
+ */
+int ledz_linux_start(const ledz_linux_config_t *config);
+
+/**
+ * Stop the Linux runtime
+ *
+ * Waits the tick thread to finish, which happens in at most one tick period. From now on
+ * the GPIO changes are given to the gpio_set function.
+ */
+void ledz_linux_stop(void);
+
+/**
+ * Get the amount of ticks run since the runtime was started
+ *
+ * @return the amount of ledz_tick calls
+ */
+uint64_t ledz_linux_ticks(void);
+
+/**
+ * Get the amount of ticks missed since the runtime was started
+ *
+ * The missed ticks are caught up by the next wake up, unless they exceed max_catchup.
+ *
+ * @return the amount of timer expirations which didn't wake up the thread in time
+ */
+uint64_t ledz_linux_overruns(void);
+
+/**
+ * Backend which calls the gpio_set and gpio_pwm functions
+ *
+ * @return the backend, used by default
+ */
+const ledz_backend_t* ledz_backend_gpio(void);
+
+/**
+ * Initialize a backend which stores the changes in memory
+ *
+ * The changes are appended to the buffer with the tick count, which is useful to test the
+ * LEDs without hardware. The buffer can be read after the runtime is stopped.
+ *
+ * @param[out] backend the backend to be initialized
+ * @param[in] memory the buffer, the events and size must be set and the count zeroed
+ */
+void ledz_backend_memory(ledz_backend_t *backend, ledz_memory_t *memory);
+
+/**
+ * Initialize a backend which writes the changes to a file descriptor
+ *
+ * Each change is written as a text line: "<tick> set|pwm <port> <pin> <value>", the file
+ * descriptor can be a regular file, a pipe or a FIFO read by another process.
+ *
+ * @param[out] backend the backend to be initialized
+ * @param[in] fd the file descriptor, which must remain open while in use
+ */
+void ledz_backend_file(ledz_backend_t *backend, int fd);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+// LEDZ_LINUX_H
+#endif
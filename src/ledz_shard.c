@@ -0,0 +1,416 @@
+/*
+ * LEDZ - The LED Zeppelin
+ * https://github.com/ricardocrudo/ledz
+ *
+ * Copyright (c) 2017 Ricardo Crudo <ricardo.crudo@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+****************************************************************************************************
+*       INCLUDE FILES
+****************************************************************************************************
+*/
+
+#include "ledz_shard.h"
+
+#ifdef LEDZ_SHARD_SUPPORT
+
+#include <stdlib.h>
+#include <pthread.h>
+
+
+/*
+****************************************************************************************************
+*       INTERNAL MACROS
+****************************************************************************************************
+*/
+
+// alignment of the shards data written by different threads
+#ifdef LEDZ_CACHE_LINE
+#define CACHE_ALIGNED       __attribute__((aligned(LEDZ_CACHE_LINE)))
+#else
+#define CACHE_ALIGNED       __attribute__((aligned(64)))
+#endif
+
+
+/*
+****************************************************************************************************
+*       INTERNAL DATA TYPES
+****************************************************************************************************
+*/
+
+enum {OUT_SET, OUT_PWM, OUT_WRITE_PORT};
+
+// GPIO change recorded while ticking a shard
+typedef struct LEDZ_OUTPUT_T {
+    uint32_t mask, values;
+    int port, pin;
+    uint8_t kind;
+} ledz_output_t;
+
+typedef struct LEDZ_SHARD_T {
+    ledz_ctx_t *ctx;
+    ledz_output_t *outputs;
+    unsigned int count, size;
+
+    // GPIO changes lost because the buffer could not grow
+    unsigned int dropped;
+} CACHE_ALIGNED ledz_shard_t;
+
+
+/*
+****************************************************************************************************
+*       INTERNAL GLOBAL VARIABLES
+****************************************************************************************************
+*/
+
+static ledz_shard_t *g_shards;
+static unsigned int g_shards_count;
+
+// next shard to be ticked, taken by the threads until all shards are done
+static unsigned int g_next;
+
+static pthread_t *g_threads;
+static unsigned int g_threads_count;
+static pthread_barrier_t g_start, g_done;
+static int g_running;
+
+// held while the threads are created, so they only use the barriers if all were created
+static pthread_mutex_t g_create_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// GPIO functions given by the user
+static ledz_gpio_t g_gpio;
+
+// shard being ticked by the current thread, null outside of the tick
+static __thread ledz_shard_t *t_shard;
+
+
+/*
+****************************************************************************************************
+*       INTERNAL FUNCTIONS
+****************************************************************************************************
+*/
+
+static void ledz_shard_record(int kind, int port, int pin, uint32_t mask, uint32_t values)
+{
+    ledz_shard_t *shard = t_shard;
+
+    // grow the buffer if a tick wrote more than expected (e.g. many queued commands)
+    if (shard->count == shard->size)
+    {
+        unsigned int size = shard->size * 2;
+        ledz_output_t *outputs = realloc(shard->outputs, size * sizeof(ledz_output_t));
+        if (!outputs)
+        {
+            shard->dropped++;
+            return;
+        }
+
+        shard->outputs = outputs;
+        shard->size = size;
+    }
+
+    ledz_output_t *output = &shard->outputs[shard->count++];
+    output->kind = kind;
+    output->port = port;
+    output->pin = pin;
+    output->mask = mask;
+    output->values = values;
+}
+
+static void ledz_shard_gpio_set(int port, int pin, int value)
+{
+    if (t_shard)
+        ledz_shard_record(OUT_SET, port, pin, 0, value);
+    else if (g_gpio.set)
+        g_gpio.set(port, pin, value);
+    else
+        LEDZ_GPIO_SET(port, pin, value);
+}
+
+static void ledz_shard_gpio_pwm(int port, int pin, int duty)
+{
+#ifdef LEDZ_GPIO_PWM
+    if (t_shard)
+        ledz_shard_record(OUT_PWM, port, pin, 0, duty);
+    else if (g_gpio.pwm)
+        g_gpio.pwm(port, pin, duty);
+    else
+        LEDZ_GPIO_PWM(port, pin, duty);
+#else
+    (void) port;
+    (void) pin;
+    (void) duty;
+#endif
+}
+
+static void ledz_shard_gpio_write_port(int port, uint32_t mask, uint32_t values)
+{
+#ifdef LEDZ_GPIO_WRITE_PORT
+    // the port writes only happen in the tick
+    ledz_shard_record(OUT_WRITE_PORT, port, 0, mask, values);
+#else
+    (void) port;
+    (void) mask;
+    (void) values;
+#endif
+}
+
+// write the recorded changes of all shards in the shard order
+static void ledz_shard_output(void)
+{
+    for (unsigned int i = 0; i < g_shards_count; i++)
+    {
+        ledz_shard_t *shard = &g_shards[i];
+
+        for (unsigned int j = 0; j < shard->count; j++)
+        {
+            ledz_output_t *output = &shard->outputs[j];
+
+            switch (output->kind)
+            {
+                case OUT_SET:
+                    ledz_shard_gpio_set(output->port, output->pin, output->values);
+                    break;
+
+#ifdef LEDZ_GPIO_PWM
+                case OUT_PWM:
+                    ledz_shard_gpio_pwm(output->port, output->pin, output->values);
+                    break;
+#endif
+
+#ifdef LEDZ_GPIO_WRITE_PORT
+                case OUT_WRITE_PORT:
+                    if (g_gpio.write_port)
+                        g_gpio.write_port(output->port, output->mask, output->values);
+                    else
+                        LEDZ_GPIO_WRITE_PORT(output->port, output->mask, output->values);
+                    break;
+#endif
+            }
+        }
+
+        shard->count = 0;
+    }
+}
+
+// free the shards of a failed start, the contexts already created are kept by the core
+static void ledz_shard_release(void)
+{
+    // the contexts are destroyed in the reverse order of their creation
+    for (unsigned int i = g_shards_count; i-- > 0; )
+    {
+        if (g_shards[i].ctx)
+            ledz_ctx_destroy(g_shards[i].ctx);
+
+        free(g_shards[i].outputs);
+    }
+
+    free(g_shards);
+    g_shards = 0;
+    g_shards_count = 0;
+}
+
+// tick the shards not yet taken by the other threads
+static void ledz_shard_work(void)
+{
+    unsigned int i;
+
+    while ((i = __atomic_fetch_add(&g_next, 1, __ATOMIC_RELAXED)) < g_shards_count)
+    {
+        t_shard = &g_shards[i];
+        ledz_ctx_tick(g_shards[i].ctx);
+    }
+
+    t_shard = 0;
+}
+
+static void* ledz_shard_thread(void *arg)
+{
+    (void) arg;
+
+    pthread_mutex_lock(&g_create_lock);
+    int running = g_running;
+    pthread_mutex_unlock(&g_create_lock);
+
+    while (running)
+    {
+        // the barriers also make the shards data visible between the threads
+        pthread_barrier_wait(&g_start);
+        if (!g_running)
+            break;
+
+        ledz_shard_work();
+        pthread_barrier_wait(&g_done);
+    }
+
+    return 0;
+}
+
+
+/*
+****************************************************************************************************
+*       GLOBAL FUNCTIONS
+****************************************************************************************************
+*/
+
+int ledz_shard_start(unsigned int shards, unsigned int instances, unsigned int threads,
+                     unsigned int tick_period, const ledz_gpio_t *gpio)
+{
+    if (g_shards || shards == 0 || threads == 0)
+        return -1;
+
+    if (gpio)
+        g_gpio = *gpio;
+
+    const ledz_gpio_t hooks = {
+        .set = ledz_shard_gpio_set,
+        .pwm = ledz_shard_gpio_pwm,
+        .write_port = ledz_shard_gpio_write_port,
+    };
+
+    void *memory;
+    if (posix_memalign(&memory, sizeof(ledz_shard_t), shards * sizeof(ledz_shard_t)))
+        return -1;
+
+    // the buffers are allocated before the contexts, which are destroyed on failure
+    g_shards = memory;
+    for (g_shards_count = 0; g_shards_count < shards; g_shards_count++)
+    {
+        ledz_shard_t *shard = &g_shards[g_shards_count];
+
+        // each led changes the GPIO and the hardware PWM at most once per tick
+        shard->size = instances * 2 + 16;
+        shard->count = 0;
+        shard->dropped = 0;
+        shard->ctx = 0;
+        shard->outputs = malloc(shard->size * sizeof(ledz_output_t));
+        if (!shard->outputs)
+        {
+            ledz_shard_release();
+            return -1;
+        }
+    }
+
+    for (unsigned int i = 0; i < shards; i++)
+    {
+        g_shards[i].ctx = ledz_ctx_create(instances, tick_period, &hooks);
+        if (!g_shards[i].ctx)
+        {
+            ledz_shard_release();
+            return -1;
+        }
+    }
+
+    // the calling thread is also a worker
+    if (threads == 1)
+        return 0;
+
+    g_threads = calloc(threads - 1, sizeof(pthread_t));
+    if (!g_threads)
+    {
+        ledz_shard_release();
+        return -1;
+    }
+
+    pthread_barrier_init(&g_start, NULL, threads);
+    pthread_barrier_init(&g_done, NULL, threads);
+    g_running = 1;
+
+    pthread_mutex_lock(&g_create_lock);
+    for (g_threads_count = 0; g_threads_count < threads - 1; g_threads_count++)
+    {
+        if (pthread_create(&g_threads[g_threads_count], NULL, ledz_shard_thread, 0))
+        {
+            // the created threads exit without waiting the barriers
+            g_running = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_create_lock);
+
+    if (!g_running)
+    {
+        ledz_shard_stop();
+        ledz_shard_release();
+        return -1;
+    }
+
+    return 0;
+}
+
+ledz_ctx_t* ledz_shard_ctx(unsigned int shard)
+{
+    return shard < g_shards_count ? g_shards[shard].ctx : 0;
+}
+
+void ledz_shard_tick(void)
+{
+    g_next = 0;
+
+    if (g_threads)
+    {
+        pthread_barrier_wait(&g_start);
+        ledz_shard_work();
+        pthread_barrier_wait(&g_done);
+    }
+    else
+    {
+        ledz_shard_work();
+    }
+
+    ledz_shard_output();
+}
+
+unsigned int ledz_shard_dropped(void)
+{
+    unsigned int dropped = 0;
+
+    for (unsigned int i = 0; i < g_shards_count; i++)
+        dropped += g_shards[i].dropped;
+
+    return dropped;
+}
+
+void ledz_shard_stop(void)
+{
+    if (!g_threads)
+        return;
+
+    // release the threads from the start barrier
+    if (g_running)
+    {
+        g_running = 0;
+        pthread_barrier_wait(&g_start);
+    }
+
+    for (unsigned int i = 0; i < g_threads_count; i++)
+        pthread_join(g_threads[i], NULL);
+
+    pthread_barrier_destroy(&g_start);
+    pthread_barrier_destroy(&g_done);
+
+    free(g_threads);
+    g_threads = 0;
+    g_threads_count = 0;
+}
+
+#endif
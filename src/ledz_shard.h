@@ -0,0 +1,152 @@
+/*
+ * LEDZ - The LED Zeppelin
+ * https://github.com/ricardocrudo/ledz
+ *
+ * Copyright (c) 2017 Ricardo Crudo <ricardo.crudo@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LEDZ_SHARD_H
+#define LEDZ_SHARD_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+****************************************************************************************************
+*       INCLUDE FILES
+****************************************************************************************************
+*/
+
+#include "ledz.h"
+
+
+/*
+****************************************************************************************************
+*       CONFIGURATION
+****************************************************************************************************
+*/
+
+// enable/disable the sharded tick for hosts with POSIX threads (optional)
+// the instances are split in shards, one context per shard, and the shards are ticked in
+// parallel by a pool of threads. Requires LEDZ_CONTEXT_SUPPORT and LEDZ_MAX_CONTEXTS
+// greater or equal to the amount of shards, LEDZ_CACHE_LINE is recommended
+//#define LEDZ_SHARD_SUPPORT
+
+
+/*
+****************************************************************************************************
+*       FUNCTION PROTOTYPES
+****************************************************************************************************
+*/
+
+/**
+ * @defgroup ledz_shard_funcs Sharded Tick Functions
+ * Set of functions to tick the LEDs from several threads
+ * @{
+ */
+
+/**
+ * Start the sharded tick
+ *
+ * Creates the shards, each one a context with the given amount of instances, and the
+ * threads which tick them. Each ledz_shard_tick is split between the calling thread and
+ * the workers, which take the next shard not yet ticked until all shards are done, so the
+ * threads which got light shards take more of them. Using more shards than threads
+ * balances the load when the busy LEDs are concentrated in some shards.
+ *
+ * The output is deterministic: the GPIO changes of each shard are recorded while ticking
+ * and written by the calling thread in the shard order once all shards are done, i.e. the
+ * same calls and order of ticking the shards one by one in a single thread. The LEDs are
+ * created in the shard contexts (see ledz_shard_ctx and ledz_ctx_led_create) and, when
+ * controlled while the tick is running, LEDZ_COMMAND_QUEUE must be defined.
+ * This function requires LEDZ_SHARD_SUPPORT to be defined.
+ *
+ * @param[in] shards the amount of shards
+ * @param[in] instances the amount of LED instances of each shard
+ * @param[in] threads the amount of threads ticking the shards, including the caller
+ * @param[in] tick_period the period in microseconds of ledz_shard_tick
+ * @param[in] gpio the GPIO functions or NULL to use the configured macros
+ *
+ * @return zero on success or -1 if the shards or threads could not be created. On failure
+ * the shards and their contexts are released and the function can be called again
+ */
+int ledz_shard_start(unsigned int shards, unsigned int instances, unsigned int threads,
+                     unsigned int tick_period, const ledz_gpio_t *gpio);
+
+/**
+ * Get the context of a shard
+ *
+ * @param[in] shard the shard index, from zero to the amount of shards - 1
+ *
+ * @return the context pointer or NULL if the shard does not exist
+ */
+ledz_ctx_t* ledz_shard_ctx(unsigned int shard);
+
+/**
+ * The tick function of the shards
+ *
+ * Ticks all shards once and writes their GPIO changes. It returns after all shards
+ * are done, so it must be called by a single thread every tick period.
+ */
+void ledz_shard_tick(void);
+
+/**
+ * Get the amount of GPIO changes lost by the shards
+ *
+ * The changes made while ticking a shard are recorded in a buffer which grows when a tick
+ * writes more than expected. When the memory can't be allocated the change is lost and the
+ * GPIO no longer matches the state of its LED until the LED changes again.
+ *
+ * @return the amount of changes lost since ledz_shard_start
+ */
+unsigned int ledz_shard_dropped(void);
+
+/**
+ * Stop the sharded tick
+ *
+ * Joins the threads. The LEDs and the shard contexts are kept and, from now on,
+ * ledz_shard_tick ticks all shards in the calling thread.
+ */
+void ledz_shard_stop(void);
+
+/**
+ * @}
+ */
+
+
+/*
+****************************************************************************************************
+*       CONFIGURATION ERRORS
+****************************************************************************************************
+*/
+
+#if defined(LEDZ_SHARD_SUPPORT) && !defined(LEDZ_CONTEXT_SUPPORT)
+#error "LEDZ_SHARD_SUPPORT requires LEDZ_CONTEXT_SUPPORT to be defined"
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+// LEDZ_SHARD_H
+#endif
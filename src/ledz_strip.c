@@ -0,0 +1,216 @@
+/*
+ * LEDZ - The LED Zeppelin
+ * https://github.com/ricardocrudo/ledz
+ *
+ * Copyright (c) 2017 Ricardo Crudo <ricardo.crudo@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+****************************************************************************************************
+*       INCLUDE FILES
+****************************************************************************************************
+*/
+
+#include "ledz_strip.h"
+
+#ifdef LEDZ_STRIP_SUPPORT
+
+#include <string.h>
+
+
+/*
+****************************************************************************************************
+*       INTERNAL MACROS
+****************************************************************************************************
+*/
+
+// first pixel byte of the APA102 frame, after the start frame of 32 zero bits
+#define APA102_START        4
+
+// the APA102 pixel starts with 3 bits set and the 5 bits of global brightness
+#define APA102_HEADER       0xE0
+
+
+/*
+****************************************************************************************************
+*       INTERNAL CONSTANTS
+****************************************************************************************************
+*/
+
+// SPI bits of a nibble, each data bit is sent as 110 (one) or 100 (zero)
+static const uint16_t g_ws2812_nibbles[16] = {
+    0x924, 0x926, 0x934, 0x936, 0x9A4, 0x9A6, 0x9B4, 0x9B6,
+    0xD24, 0xD26, 0xD34, 0xD36, 0xDA4, 0xDA6, 0xDB4, 0xDB6,
+};
+
+// order in which the RGB(W) channels are sent
+static const uint8_t g_order[][4] = {
+    [LEDZ_WS2812] = {LEDZ_STRIP_GREEN, LEDZ_STRIP_RED, LEDZ_STRIP_BLUE},
+    [LEDZ_SK6812] = {LEDZ_STRIP_GREEN, LEDZ_STRIP_RED, LEDZ_STRIP_BLUE, LEDZ_STRIP_WHITE},
+    [LEDZ_APA102] = {LEDZ_STRIP_BLUE, LEDZ_STRIP_GREEN, LEDZ_STRIP_RED},
+};
+
+
+/*
+****************************************************************************************************
+*       INTERNAL GLOBAL VARIABLES
+****************************************************************************************************
+*/
+
+static ledz_strip_t *g_strips[LEDZ_MAX_STRIPS];
+
+
+/*
+****************************************************************************************************
+*       INTERNAL FUNCTIONS
+****************************************************************************************************
+*/
+
+static inline void ledz_strip_channel(int port, int pin, uint8_t value)
+{
+    if (port < 0 || port >= LEDZ_MAX_STRIPS || !g_strips[port])
+        return;
+
+    ledz_strip_t *strip = g_strips[port];
+    if (pin < 0 || pin >= strip->pixels * strip->channels || strip->colors[pin] == value)
+        return;
+
+    strip->colors[pin] = value;
+
+    unsigned int pixel = pin / strip->channels;
+    strip->dirty[pixel / 32] |= 1u << (pixel % 32);
+}
+
+static inline void ledz_ws2812_pixel(const ledz_strip_t *strip, unsigned int pixel)
+{
+    const uint8_t *colors = &strip->colors[pixel * strip->channels];
+    const uint8_t *order = g_order[strip->type];
+    uint8_t *frame = &strip->frame[pixel * strip->channels * 3];
+
+    for (int i = 0; i < strip->channels; i++)
+    {
+        uint8_t color = colors[order[i]];
+        uint32_t bits = ((uint32_t) g_ws2812_nibbles[color >> 4] << 12) |
+                        g_ws2812_nibbles[color & 0x0F];
+
+        *frame++ = bits >> 16;
+        *frame++ = bits >> 8;
+        *frame++ = bits;
+    }
+}
+
+static inline void ledz_apa102_pixel(const ledz_strip_t *strip, unsigned int pixel)
+{
+    const uint8_t *colors = &strip->colors[pixel * 3];
+    uint8_t *frame = &strip->frame[APA102_START + pixel * 4];
+
+    frame[0] = APA102_HEADER | strip->brightness;
+    frame[1] = colors[LEDZ_STRIP_BLUE];
+    frame[2] = colors[LEDZ_STRIP_GREEN];
+    frame[3] = colors[LEDZ_STRIP_RED];
+}
+
+
+/*
+****************************************************************************************************
+*       GLOBAL FUNCTIONS
+****************************************************************************************************
+*/
+
+int ledz_strip_init(ledz_strip_t *strip, int port, ledz_strip_type_t type, uint16_t pixels,
+                    uint8_t *colors, uint32_t *dirty, uint8_t *frame)
+{
+    if (port < 0 || port >= LEDZ_MAX_STRIPS || pixels > LEDZ_STRIP_MAX_PIXELS(type))
+        return -1;
+
+    strip->type = type;
+    strip->pixels = pixels;
+    strip->channels = LEDZ_STRIP_CHANNELS(type);
+    strip->brightness = 31;
+    strip->colors = colors;
+    strip->dirty = dirty;
+    strip->frame = frame;
+    strip->frame_size = LEDZ_STRIP_FRAME_SIZE(type, pixels);
+
+    // the start, end and reset frames are zeros, the APA102 end frame only gives the clock
+    // edges to shift the data through the strip
+    memset(colors, 0, LEDZ_STRIP_COLORS_SIZE(type, pixels));
+    memset(frame, 0, strip->frame_size);
+
+    ledz_strip_brightness(strip, strip->brightness);
+    ledz_strip_encode(strip);
+
+    g_strips[port] = strip;
+
+    return 0;
+}
+
+void ledz_strip_brightness(ledz_strip_t *strip, uint8_t brightness)
+{
+    strip->brightness = brightness & 0x1F;
+
+    // all pixels carry the global brightness
+    memset(strip->dirty, 0xFF, LEDZ_STRIP_DIRTY_SIZE(strip->pixels) * sizeof(uint32_t));
+}
+
+unsigned int ledz_strip_encode(ledz_strip_t *strip)
+{
+    unsigned int count = 0, words = LEDZ_STRIP_DIRTY_SIZE(strip->pixels);
+
+    for (unsigned int i = 0; i < words; i++)
+    {
+        uint32_t dirty = strip->dirty[i];
+        strip->dirty[i] = 0;
+
+        // only the set bits are visited, 32 clean pixels are skipped at once
+        while (dirty)
+        {
+            unsigned int pixel = i * 32 + __builtin_ctz(dirty);
+            dirty &= dirty - 1;
+
+            // the bits of the last word beyond the pixels are set by ledz_strip_brightness
+            if (pixel >= strip->pixels)
+                break;
+
+            if (strip->type == LEDZ_APA102)
+                ledz_apa102_pixel(strip, pixel);
+            else
+                ledz_ws2812_pixel(strip, pixel);
+
+            count++;
+        }
+    }
+
+    return count;
+}
+
+void ledz_strip_set(int port, int pin, int value)
+{
+    ledz_strip_channel(port, pin, value == LEDZ_TURN_ON_VALUE ? 255 : 0);
+}
+
+void ledz_strip_pwm(int port, int pin, int duty)
+{
+    ledz_strip_channel(port, pin, (duty * 255 + LEDZ_PWM_MAX / 2) / LEDZ_PWM_MAX);
+}
+
+#endif
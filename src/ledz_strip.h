@@ -0,0 +1,228 @@
+/*
+ * LEDZ - The LED Zeppelin
+ * https://github.com/ricardocrudo/ledz
+ *
+ * Copyright (c) 2017 Ricardo Crudo <ricardo.crudo@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef LEDZ_STRIP_H
+#define LEDZ_STRIP_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+****************************************************************************************************
+*       INCLUDE FILES
+****************************************************************************************************
+*/
+
+#include <stdint.h>
+#include "ledz.h"
+
+
+/*
+****************************************************************************************************
+*       CONFIGURATION
+****************************************************************************************************
+*/
+
+// enable/disable the addressable LED strips (optional)
+// the LEDs of a strip are pixels of a buffer instead of GPIOs, the GPIO macros must be set to
+// the strip functions and the port argument selects the strip:
+// #define LEDZ_GPIO_SET(port,pin,value)   ledz_strip_set(port,pin,value)
+// #define LEDZ_GPIO_PWM(port,pin,duty)    ledz_strip_pwm(port,pin,duty)
+//#define LEDZ_STRIP_SUPPORT
+
+// maximum of strips, the strip port goes from 0 to LEDZ_MAX_STRIPS - 1
+#ifndef LEDZ_MAX_STRIPS
+#define LEDZ_MAX_STRIPS         2
+#endif
+
+// low time in us which latches the colors of WS2812 and SK6812 strips
+// (50us for the original WS2812, 280us for the newer parts)
+#ifndef LEDZ_STRIP_RESET_US
+#define LEDZ_STRIP_RESET_US     280
+#endif
+
+
+/*
+****************************************************************************************************
+*       MACROS
+****************************************************************************************************
+*/
+
+// color channels of the pin argument, the pin of a channel is: pixel * channels + channel
+#define LEDZ_STRIP_RED          0
+#define LEDZ_STRIP_GREEN        1
+#define LEDZ_STRIP_BLUE         2
+#define LEDZ_STRIP_WHITE        3
+
+// the WS2812 and SK6812 bits are sent through SPI at 2.4MHz, 3 SPI bits per data bit
+#define LEDZ_STRIP_SPI_HZ       2400000
+
+// amount of channels per pixel
+#define LEDZ_STRIP_CHANNELS(type)           ((type) == LEDZ_SK6812 ? 4 : 3)
+
+// maximum of pixels of a strip, the pins of its channels must fit the 16 bits pin of the LEDs
+#define LEDZ_STRIP_MAX_PIXELS(type)         (65536 / LEDZ_STRIP_CHANNELS(type))
+
+// bytes of the reset time of WS2812 and SK6812 (rounded up)
+#define LEDZ_STRIP_RESET_BYTES  ((LEDZ_STRIP_RESET_US * (LEDZ_STRIP_SPI_HZ / 100000) + 79) / 80)
+
+// sizes of the buffers given to ledz_strip_init
+#define LEDZ_STRIP_COLORS_SIZE(type,pixels) ((pixels) * LEDZ_STRIP_CHANNELS(type))
+#define LEDZ_STRIP_DIRTY_SIZE(pixels)       (((pixels) + 31) / 32)
+#define LEDZ_STRIP_FRAME_SIZE(type,pixels)  ((type) == LEDZ_APA102 ? \
+    4 + (pixels) * 4 + ((pixels) + 15) / 16 + 4 : \
+    (pixels) * LEDZ_STRIP_CHANNELS(type) * 3 + LEDZ_STRIP_RESET_BYTES)
+
+
+/*
+****************************************************************************************************
+*       DATA TYPES
+****************************************************************************************************
+*/
+
+/**
+ * @struct ledz_strip_type_t
+ * Strip types, the colors are sent as GRB (WS2812), GRBW (SK6812) or BGR (APA102)
+ */
+typedef enum ledz_strip_type_t {LEDZ_WS2812, LEDZ_SK6812, LEDZ_APA102} ledz_strip_type_t;
+
+/**
+ * @struct ledz_strip_t
+ * An addressable LED strip, the buffers are given by the user to ledz_strip_init
+ */
+typedef struct ledz_strip_t {
+    ledz_strip_type_t type;
+    uint16_t pixels;
+    uint8_t channels;
+
+    // APA102 global brightness, from 0 to 31
+    uint8_t brightness;
+
+    // 8 bits per channel in RGB(W) order, and one dirty bit per pixel
+    uint8_t *colors;
+    uint32_t *dirty;
+
+    // encoded frame, sent as is through SPI
+    uint8_t *frame;
+    uint32_t frame_size;
+} ledz_strip_t;
+
+
+/*
+****************************************************************************************************
+*       FUNCTION PROTOTYPES
+****************************************************************************************************
+*/
+
+/**
+ * @defgroup ledz_strip_funcs Strip Functions
+ * Set of functions to control addressable LED strips
+ * @{
+ */
+
+/**
+ * Initialize a strip
+ *
+ * Registers the strip in the given port, so the LEDs created with this port change its
+ * pixels. A RGB pixel is a LEDZ_3COLOR LED with the pins pixel * 3 + LEDZ_STRIP_RED,
+ * LEDZ_STRIP_GREEN and LEDZ_STRIP_BLUE (channels of 4 with LEDZ_SK6812). All pixels start
+ * off and the frame is fully encoded. The pins go up to 65535, so a strip has at most
+ * LEDZ_STRIP_MAX_PIXELS(type) pixels, 21845 RGB or 16384 RGBW pixels.
+ * This function requires LEDZ_STRIP_SUPPORT to be defined.
+ *
+ * @param[out] strip the strip to be initialized
+ * @param[in] port the strip port, from 0 to LEDZ_MAX_STRIPS - 1
+ * @param[in] type the strip type
+ * @param[in] pixels the amount of pixels, up to LEDZ_STRIP_MAX_PIXELS(type)
+ * @param[in] colors buffer of LEDZ_STRIP_COLORS_SIZE(type, pixels) bytes
+ * @param[in] dirty buffer of LEDZ_STRIP_DIRTY_SIZE(pixels) words
+ * @param[in] frame buffer of LEDZ_STRIP_FRAME_SIZE(type, pixels) bytes
+ *
+ * @return zero on success or -1 if the port is invalid or the strip has too many pixels
+ */
+int ledz_strip_init(ledz_strip_t *strip, int port, ledz_strip_type_t type, uint16_t pixels,
+                    uint8_t *colors, uint32_t *dirty, uint8_t *frame);
+
+/**
+ * Set the global brightness of an APA102 strip
+ *
+ * @param[in] strip the strip
+ * @param[in] brightness the brightness, from 0 to 31
+ */
+void ledz_strip_brightness(ledz_strip_t *strip, uint8_t brightness);
+
+/**
+ * Encode the pixels changed since the last call
+ *
+ * Only the dirty pixels are encoded, the others keep their bytes of the frame. It must not
+ * run concurrently with ledz_tick, e.g. call it in the tick ISR after ledz_tick and start
+ * the SPI transfer of strip->frame when it returns non zero.
+ *
+ * @param[in] strip the strip
+ *
+ * @return the amount of pixels encoded
+ */
+unsigned int ledz_strip_encode(ledz_strip_t *strip);
+
+/**
+ * GPIO set function of the strips, to be used by the LEDZ_GPIO_SET macro
+ *
+ * The channel is set to 255 when the value is LEDZ_TURN_ON_VALUE or to 0 otherwise.
+ * Ports without a strip are ignored.
+ */
+void ledz_strip_set(int port, int pin, int value);
+
+/**
+ * GPIO PWM function of the strips, to be used by the LEDZ_GPIO_PWM macro
+ *
+ * The duty cycle is scaled from 0 - LEDZ_PWM_MAX to 0 - 255.
+ * Ports without a strip are ignored.
+ */
+void ledz_strip_pwm(int port, int pin, int duty);
+
+/**
+ * @}
+ */
+
+
+/*
+****************************************************************************************************
+*       CONFIGURATION ERRORS
+****************************************************************************************************
+*/
+
+#if defined(LEDZ_STRIP_SUPPORT) && defined(LEDZ_BRIGHTNESS_SUPPORT) && !defined(LEDZ_GPIO_PWM)
+#error "LEDZ_STRIP_SUPPORT requires LEDZ_GPIO_PWM, the internal PWM can't drive the pixels"
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+// LEDZ_STRIP_H
+#endif
@@ -0,0 +1,130 @@
+/*
+ * LEDZ - The LED Zeppelin
+ * https://github.com/ricardocrudo/ledz
+ *
+ * Copyright (c) 2017 Ricardo Crudo <ricardo.crudo@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+****************************************************************************************************
+*       INCLUDE FILES
+****************************************************************************************************
+*/
+
+#include "ledz_waveform.h"
+
+#ifdef LEDZ_WAVEFORM_SUPPORT
+
+#include <string.h>
+
+
+/*
+****************************************************************************************************
+*       INTERNAL GLOBAL VARIABLES
+****************************************************************************************************
+*/
+
+static ledz_waveform_t *g_waveforms[LEDZ_MAX_WAVEFORMS];
+
+
+/*
+****************************************************************************************************
+*       INTERNAL FUNCTIONS
+****************************************************************************************************
+*/
+
+static inline void ledz_waveform_render(int port, int pin, int on_ticks)
+{
+    if (port < 0 || port >= LEDZ_MAX_WAVEFORMS || !g_waveforms[port])
+        return;
+
+    if (pin < 0 || pin >= LEDZ_WAVEFORM_PINS)
+        return;
+
+    if (on_ticks < 0)
+        on_ticks = 0;
+    else if (on_ticks > LEDZ_PWM_MAX)
+        on_ticks = LEDZ_PWM_MAX;
+
+    ledz_waveform_t *wave = g_waveforms[port];
+    uint32_t bit = 1u << pin;
+
+    // the ticks between the old and the new duty cycle are the only ones which change, a pin
+    // not rendered yet has its reset value in all ticks
+    int from = 0, to = LEDZ_PWM_MAX;
+    if (wave->pins & bit)
+    {
+        int old = wave->on_ticks[pin];
+        if (old == on_ticks)
+            return;
+
+        from = old < on_ticks ? old : on_ticks;
+        to = old < on_ticks ? on_ticks : old;
+    }
+
+    wave->pins |= bit;
+    wave->on_ticks[pin] = on_ticks;
+
+    uint32_t mask = LEDZ_WAVEFORM_WORD(bit, bit);
+    uint32_t on = LEDZ_TURN_ON_VALUE ? LEDZ_WAVEFORM_WORD(bit, 0) : LEDZ_WAVEFORM_WORD(0, bit);
+    uint32_t off = mask & ~on;
+
+    // the words are written one by one, the DMA reads either the old or the new word
+    uint32_t *table = wave->table;
+    for (int i = from; i < to; i++)
+        table[i] = (table[i] & ~mask) | (i < on_ticks ? on : off);
+}
+
+
+/*
+****************************************************************************************************
+*       GLOBAL FUNCTIONS
+****************************************************************************************************
+*/
+
+int ledz_waveform_init(ledz_waveform_t *wave, int port, uint32_t *table)
+{
+    if (port < 0 || port >= LEDZ_MAX_WAVEFORMS)
+        return -1;
+
+    wave->table = table;
+    wave->pins = 0;
+
+    memset(wave->on_ticks, 0, sizeof(wave->on_ticks));
+    memset(table, 0, LEDZ_WAVEFORM_SIZE * sizeof(uint32_t));
+
+    g_waveforms[port] = wave;
+
+    return 0;
+}
+
+void ledz_waveform_set(int port, int pin, int value)
+{
+    ledz_waveform_render(port, pin, value == LEDZ_TURN_ON_VALUE ? LEDZ_PWM_MAX : 0);
+}
+
+void ledz_waveform_pwm(int port, int pin, int duty)
+{
+    ledz_waveform_render(port, pin, duty);
+}
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * LEDZ - The LED Zeppelin
+ * https://github.com/ricardocrudo/ledz
+ *
+ * Copyright (c) 2017 Ricardo Crudo <ricardo.crudo@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LEDZ_WAVEFORM_H
+#define LEDZ_WAVEFORM_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+****************************************************************************************************
+*       INCLUDE FILES
+****************************************************************************************************
+*/
+
+#include <stdint.h>
+#include "ledz.h"
+
+
+/*
+****************************************************************************************************
+*       CONFIGURATION
+****************************************************************************************************
+*/
+
+// enable/disable the PWM waveform tables (optional)
+// one PWM period of the LEDs of a port is rendered as a table with one word per tick, which
+// a DMA channel triggered by the tick timer copies to the set/reset register of the port.
+// The GPIO macros must be set to the waveform functions and the port argument selects the
+// table:
+// #define LEDZ_GPIO_SET(port,pin,value)   ledz_waveform_set(port,pin,value)
+// #define LEDZ_GPIO_PWM(port,pin,duty)    ledz_waveform_pwm(port,pin,duty)
+//#define LEDZ_WAVEFORM_SUPPORT
+
+// maximum of ports with a table, the port goes from 0 to LEDZ_MAX_WAVEFORMS - 1
+#ifndef LEDZ_MAX_WAVEFORMS
+#define LEDZ_MAX_WAVEFORMS      2
+#endif
+
+// word of the table which sets and resets the pins of the masks, the word must be the
+// bitwise OR of a set part and a reset part. The default is the BSRR register of the STM32,
+// where the pins go from 0 to 15
+#ifndef LEDZ_WAVEFORM_WORD
+#define LEDZ_WAVEFORM_WORD(set,reset)   ((uint32_t) (reset) << 16 | (uint32_t) (set))
+#endif
+
+// amount of pins of a port that fit in the set and reset parts of the word, the pins go from
+// 0 to LEDZ_WAVEFORM_PINS - 1 and the others are ignored. Adjust it with LEDZ_WAVEFORM_WORD,
+// e.g. 8 for a word with 8 bits in each part (maximum 32)
+#ifndef LEDZ_WAVEFORM_PINS
+#define LEDZ_WAVEFORM_PINS      16
+#endif
+
+
+/*
+****************************************************************************************************
+*       MACROS
+****************************************************************************************************
+*/
+
+// amount of words of the table given to ledz_waveform_init, one per tick of the PWM period
+#define LEDZ_WAVEFORM_SIZE      LEDZ_PWM_MAX
+
+
+/*
+****************************************************************************************************
+*       DATA TYPES
+****************************************************************************************************
+*/
+
+/**
+ * @struct ledz_waveform_t
+ * The PWM waveform of a port, the table is given by the user to ledz_waveform_init
+ */
+typedef struct ledz_waveform_t {
+    // one word per tick, the word n is written to the port in the tick n of each period
+    uint32_t *table;
+
+    // pins rendered in the table and the ticks of the period in which each pin is on
+    uint32_t pins;
+    uint16_t on_ticks[LEDZ_WAVEFORM_PINS];
+} ledz_waveform_t;
+
+
+/*
+****************************************************************************************************
+*       FUNCTION PROTOTYPES
+****************************************************************************************************
+*/
+
+/**
+ * @defgroup ledz_waveform_funcs Waveform Functions
+ * Set of functions to render the PWM of the LEDs as tables played by DMA
+ * @{
+ */
+
+/**
+ * Initialize the waveform of a port
+ *
+ * Registers the table in the given port, so the LEDs created with this port are rendered in
+ * it. A pin is on from the first tick of the period during its duty cycle and off in the
+ * remaining ticks. The table starts empty, i.e. the words don't change any pin, and the pins
+ * are added to the table by their first GPIO change.
+ * This function requires LEDZ_WAVEFORM_SUPPORT to be defined.
+ *
+ * @param[out] wave the waveform to be initialized
+ * @param[in] port the port, from 0 to LEDZ_MAX_WAVEFORMS - 1
+ * @param[in] table buffer of LEDZ_WAVEFORM_SIZE words
+ *
+ * @return zero on success or -1 if the port is invalid
+ */
+int ledz_waveform_init(ledz_waveform_t *wave, int port, uint32_t *table);
+
+/**
+ * GPIO set function of the waveforms, to be used by the LEDZ_GPIO_SET macro
+ *
+ * The pin is rendered on or off during the whole period. Only the words of the ticks in
+ * which the pin changes are written. Ports without a waveform and pins from
+ * LEDZ_WAVEFORM_PINS on are ignored.
+ */
+void ledz_waveform_set(int port, int pin, int value);
+
+/**
+ * GPIO PWM function of the waveforms, to be used by the LEDZ_GPIO_PWM macro
+ *
+ * The pin is rendered on during the first duty ticks of the period. Only the words between
+ * the previous and the new duty cycle are written, e.g. a fade step writes one or a few
+ * words. Ports without a waveform and pins from LEDZ_WAVEFORM_PINS on are ignored.
+ */
+void ledz_waveform_pwm(int port, int pin, int duty);
+
+/**
+ * @}
+ */
+
+
+/*
+****************************************************************************************************
+*       CONFIGURATION ERRORS
+****************************************************************************************************
+*/
+
+#if defined(LEDZ_WAVEFORM_SUPPORT) && defined(LEDZ_BRIGHTNESS_SUPPORT) && !defined(LEDZ_GPIO_PWM)
+#error "LEDZ_WAVEFORM_SUPPORT requires LEDZ_GPIO_PWM, the internal PWM would write every edge"
+#endif
+
+#if defined(LEDZ_WAVEFORM_SUPPORT) && (LEDZ_WAVEFORM_PINS < 1 || LEDZ_WAVEFORM_PINS > 32)
+#error "LEDZ_WAVEFORM_PINS must be from 1 to 32, the pins of a port are kept in a 32 bits mask"
+#endif
+
+#if defined(LEDZ_WAVEFORM_SUPPORT) && defined(LEDZ_GPIO_WRITE_PORT)
+#error "LEDZ_WAVEFORM_SUPPORT can't be used with LEDZ_GPIO_WRITE_PORT"
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+// LEDZ_WAVEFORM_H
+#endif
@@ -1,10 +1,11 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <pthread.h>
-#include "ledz.h"
+#include "ledz_linux.h"
 
 #define UNUSED_PARAM(var) do { (void)(var); } while (0)
 
+#ifndef LEDZ_LINUX_SUPPORT
 static void* tick(void *arg)
 {
     UNUSED_PARAM(arg);
@@ -17,6 +18,7 @@ static void* tick(void *arg)
 
     return 0;
 }
+#endif
 
 void gpio_set(int port, int pin, int value)
 {
@@ -46,6 +48,12 @@ int main(void)
     ledz_blink(led1, LEDZ_RED, 500, 500);
     ledz_blink(led2, LEDZ_GREEN, 100, 1000);
 
+#ifdef LEDZ_LINUX_SUPPORT
+    // tick thread driven by a timer
+    ledz_linux_start(NULL);
+    sleep(5);
+    ledz_linux_stop();
+#else
     // set thread attributes
     pthread_attr_t attributes;
     pthread_attr_init(&attributes);
@@ -61,6 +69,7 @@ int main(void)
     // kill thread
     pthread_cancel(thread);
     pthread_join(thread, NULL);
+#endif
 
     // show cursor and reset color
     fputs("\e[?25h\e[39m\n", stdout);
@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include "ledz.h"
+#include "check.h"
+
+// rising edges recorded per port, at most one per 100 ms in the 5 s run
+#define MAX_EDGES       50
+
+// late wake ups of the sleep are tolerated up to this time
+#define TOLERANCE_US    20000
+
+static uint32_t edges[3][MAX_EDGES];
+static unsigned int edges_count[3];
+static int state[3];
+
+static uint32_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void gpio_set(int port, int pin, int value)
+{
+    int on = value == LEDZ_TURN_ON_VALUE;
+    if (on && !state[port] && edges_count[port] < MAX_EDGES)
+        edges[port][edges_count[port]++] = now_us();
+
+    state[port] = on;
+
+    if (value != LEDZ_TURN_ON_VALUE)
+    {
+        // change to color gray (led off)
+        pin = 90;
+    }
+
+    // select color and draw full circle
+    printf("\e[%iG\e[0;%im\xE2\x97\x8F ",(port * 2) - 1, pin);
+
+    fflush(stdout);
+}
+
+// the led turns on once per period
+static int periodic(int port, uint32_t period_ms)
+{
+    if (edges_count[port] < 4)
+    {
+        printf("port %d: %u rising edges\n", port, edges_count[port]);
+        return 0;
+    }
+
+    for (unsigned int i = 1; i < edges_count[port]; i++)
+    {
+        int32_t error = edges[port][i] - edges[port][i - 1] - period_ms * 1000;
+        if (error < -TOLERANCE_US || error > TOLERANCE_US)
+        {
+            printf("port %d: edge %u is %d us off\n", port, i, error);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int main(void)
+{
+    // hide cursor
+    fputs("\e[?25l", stdout);
+
+    ledz_t* led1 =
+        ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED},   (const int []){1, 31});
+
+    ledz_t* led2 =
+        ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_GREEN}, (const int []){2, 32});
+
+    ledz_blink(led1, LEDZ_RED, 500, 500);
+    ledz_blink(led2, LEDZ_GREEN, 100, 1000);
+
+    // sleep until the next led event instead of calling ledz_tick periodically
+    uint32_t start = now_us(), last = start;
+    unsigned int wakeups = 0;
+    while (last - start < 5000000)
+    {
+        wakeups++;
+        uint32_t next = ledz_next_event_us();
+        usleep(next == LEDZ_NO_EVENT ? 100000 : next);
+
+        uint32_t now = now_us();
+        ledz_advance(now - last);
+        last = now;
+    }
+
+    // show cursor and reset color
+    fputs("\e[?25h\e[39m\n", stdout);
+
+    check(periodic(1, 1000), "blink 500/500 has a 1000 ms period");
+    check(periodic(2, 1100), "blink 100/1000 has a 1100 ms period");
+
+    // each led changes twice per period, a periodic tick would wake up 50000 times
+    printf("wake ups: %u\n", wakeups);
+    check(wakeups < 100, "wakes up only for the led events");
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <math.h>
+#include "ledz.h"
+#include "curves.h"
+
+// amount of ticks measured, multiple of the PWM or BAM period
+#ifdef LEDZ_BAM_SUPPORT
+#define TICKS   (4 * ((1 << LEDZ_BAM_BITS) - 1))
+#else
+#define TICKS   (4 * LEDZ_PWM_MAX)
+#endif
+
+// test about 100 brightness values independent of the resolution
+#define STEP    (LEDZ_BRIGHTNESS_MAX / 100)
+
+static int led_state;
+
+void gpio_set(int port, int pin, int value)
+{
+    (void) port;
+    (void) pin;
+
+    led_state = (value == LEDZ_TURN_ON_VALUE);
+}
+
+int main(void)
+{
+#ifdef LEDZ_BAM_SUPPORT
+    // BAM quantizes the duty cycle with LEDZ_BAM_BITS
+    const double tolerance = 50.0 / ((1 << LEDZ_BAM_BITS) - 1);
+    const char *engine = "BAM";
+#elif defined(LEDZ_DITHER_SUPPORT)
+    // the dithering adds up to one tick to the periods to follow the curve without rounding
+    const double tolerance = 100.0 / LEDZ_PWM_MAX;
+    const char *engine = "dithered PWM";
+#else
+    const double tolerance = 0.0;
+    const char *engine = "PWM";
+#endif
+
+    ledz_t* led =
+        ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, (const int []){1, 31});
+
+    int errors = 0;
+    for (unsigned int value = 0; value <= LEDZ_BRIGHTNESS_MAX; value += STEP)
+    {
+        ledz_brightness(led, LEDZ_RED, value);
+
+        // let the engine settle
+        for (int i = 0; i < TICKS; i++)
+            ledz_tick();
+
+        int on = 0;
+        for (int i = 0; i < TICKS; i++)
+        {
+            ledz_tick();
+            on += led_state;
+        }
+
+        double duty = on * 100.0 / TICKS;
+        double expected = cie1931[value] * 100.0 / LEDZ_PWM_MAX;
+        if (fabs(duty - expected) > tolerance + 1E-9)
+        {
+            printf("brightness %5u: duty %.2f%% expected %.2f%%\n", value, duty, expected);
+            errors++;
+        }
+    }
+
+    printf("%s average duty cycle: %s\n", engine, errors ? "FAILED" : "OK");
+
+    ledz_destroy(led);
+
+    return errors != 0;
+}
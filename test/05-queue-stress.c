@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "ledz.h"
+
+// build and run with ThreadSanitizer using: make tsan
+
+#define UNUSED_PARAM(var) do { (void)(var); } while (0)
+
+#define LEDS        3
+#define COMMANDS    20000
+
+static int led_state[LEDS];
+
+#ifdef LEDZ_COMMAND_QUEUE
+static int running = 1;
+
+static void* tick(void *arg)
+{
+    UNUSED_PARAM(arg);
+
+    while (__atomic_load_n(&running, __ATOMIC_RELAXED))
+        ledz_tick();
+
+    return 0;
+}
+#endif
+
+void gpio_set(int port, int pin, int value)
+{
+    UNUSED_PARAM(port);
+
+    led_state[pin] = (value == LEDZ_TURN_ON_VALUE);
+}
+
+int main(void)
+{
+#ifndef LEDZ_COMMAND_QUEUE
+    printf("skipped: LEDZ_COMMAND_QUEUE is not defined\n");
+    return 0;
+#else
+    const ledz_color_t colors[LEDS] = {LEDZ_RED, LEDZ_GREEN, LEDZ_BLUE};
+
+    ledz_t* led =
+        ledz_create(LEDZ_3COLOR, colors, (const int []){1, 0, 1, 1, 1, 2});
+
+    // without the tick a full queue drops the command instead of waiting forever
+    for (int i = 0; i <= LEDZ_QUEUE_SIZE; i++)
+        ledz_toggle(led, LEDZ_RED);
+
+    int errors = 0;
+    if (ledz_queue_dropped() != 1)
+    {
+        printf("full queue: expected 1 dropped command, got %u\n", ledz_queue_dropped());
+        errors++;
+    }
+
+    ledz_tick();
+
+    // create thread
+    pthread_t thread;
+    pthread_create(&thread, NULL, tick, 0);
+
+    // hammer the tick with all kind of commands
+    srand(1);
+    for (int i = 0; i < COMMANDS; i++)
+    {
+        ledz_color_t color = colors[rand() % LEDS];
+
+        switch (rand() % 6)
+        {
+            case 0:
+                ledz_set(led, color, rand() % 2);
+                break;
+
+            case 1:
+                ledz_toggle(led, color);
+                break;
+
+            case 2:
+                ledz_blink(led, color, 1 + rand() % 5, 1 + rand() % 5);
+                break;
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+            case 3:
+                ledz_brightness(led, color, rand() % (LEDZ_BRIGHTNESS_MAX + 1));
+                break;
+
+            case 4:
+                ledz_fade_in(led, color, 1 + rand() % 100, LEDZ_BRIGHTNESS_MAX);
+                break;
+
+            case 5:
+                ledz_fade_out(led, color, 1 + rand() % 100, 0);
+                break;
+#endif
+        }
+    }
+
+    // the last command of each led defines its final state, so it is sent again if dropped
+    int expected[LEDS];
+    for (int i = 0; i < LEDS; i++)
+    {
+        unsigned int dropped;
+        expected[i] = i % 2;
+
+        do
+        {
+            dropped = ledz_queue_dropped();
+            ledz_set(led, colors[i], expected[i]);
+        } while (ledz_queue_dropped() != dropped);
+    }
+
+    // stop thread
+    __atomic_store_n(&running, 0, __ATOMIC_RELAXED);
+    pthread_join(thread, NULL);
+
+    // apply the remaining commands
+    ledz_tick();
+
+    for (int i = 0; i < LEDS; i++)
+    {
+        if (led_state[i] != expected[i])
+        {
+            printf("led %i: expected %i, got %i\n", i, expected[i], led_state[i]);
+            errors++;
+        }
+    }
+
+    printf("%i commands: %s\n", COMMANDS + LEDS, errors ? "FAIL" : "OK");
+
+    return errors ? 1 : 0;
+#endif
+}
@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "sim.h"
+#include "curves.h"
+
+// simulated time
+#define MINUTES         4
+
+// blink times in ms
+#define TIME_ON         30
+#define TIME_OFF        70
+
+// fade rate in ms per brightness unit
+#define FADE_RATE       2
+
+#ifdef LEDZ_BAM_SUPPORT
+#define PERIOD_TICKS    ((1 << LEDZ_BAM_BITS) - 1)
+#else
+#define PERIOD_TICKS    LEDZ_PWM_MAX
+#endif
+
+static int errors;
+
+static void check(int ok, const char *what, double expected, double measured)
+{
+    printf("%-28s expected %10.3f measured %10.3f: %s\n", what, expected, measured,
+           ok ? "OK" : "FAIL");
+
+    if (!ok)
+        errors++;
+}
+
+int main(void)
+{
+    ledz_t* led = ledz_create(LEDZ_3COLOR,
+        (const ledz_color_t []){LEDZ_RED, LEDZ_GREEN, LEDZ_BLUE},
+        (const int []){1, 0, 1, 1, 1, 2});
+
+    // channels are numbered by the order of the first transition
+    int blink = sim_channel(1, 0);
+    int pwm = sim_channel(1, 1);
+    int fade = sim_channel(1, 2);
+
+    const unsigned int value = LEDZ_BRIGHTNESS_MAX / 2;
+
+    ledz_blink(led, LEDZ_RED, TIME_ON, TIME_OFF);
+    ledz_brightness(led, LEDZ_GREEN, value);
+    ledz_fade_in(led, LEDZ_BLUE, FADE_RATE, LEDZ_BRIGHTNESS_MAX);
+
+    clock_t start = clock();
+    sim_run(SIM_TICKS(MINUTES * 60000));
+    double wall_ms = (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+
+    printf("simulated %d minutes in %.1f ms (%u transitions)\n", MINUTES, wall_ms,
+           sim_events_count);
+
+    // skip the first second to discard the initial state of the counters
+    uint32_t from = SIM_TICKS(1000);
+    uint32_t to = SIM_TICKS(61000);
+
+    // blink period and time on
+    uint32_t period = sim_period(blink, from, to);
+    check(period == SIM_TICKS(TIME_ON + TIME_OFF), "blink period (ms)",
+          TIME_ON + TIME_OFF, SIM_US(period) / 1000.0);
+
+    uint32_t cycles = 500;
+    uint32_t high = sim_high_time(blink, from, from + cycles * period);
+    check(high == cycles * SIM_TICKS(TIME_ON), "blink time on (ms)",
+          TIME_ON, SIM_US(high) / 1000.0 / cycles);
+
+    double expected = 100.0 * cie1931[value] / LEDZ_PWM_MAX;
+
+#ifdef LEDZ_GPIO_PWM
+    // the last duty cycle set to the hardware PWM
+    int duty = -1;
+    for (unsigned int i = 0; i < sim_events_count; i++)
+    {
+        if (sim_events[i].channel == pwm && sim_events[i].kind == SIM_PWM)
+            duty = sim_events[i].value;
+    }
+
+    check(duty == cie1931[value], "hardware PWM duty (%)", expected,
+          100.0 * duty / LEDZ_PWM_MAX);
+
+    // each fade step must set the next duty cycle of the curve after FADE_RATE ms
+    int step = 0, fade_ok = 1;
+    uint32_t last = 0;
+    for (unsigned int i = 0; i < sim_events_count; i++)
+    {
+        sim_event_t *event = &sim_events[i];
+        if (event->channel != fade || event->kind != SIM_PWM)
+            continue;
+
+        step++;
+        if (event->value != cie1931[step] ||
+            (step > 1 && event->tick - last != SIM_TICKS(FADE_RATE)))
+            fade_ok = 0;
+
+        last = event->tick;
+    }
+
+    check(fade_ok && step == LEDZ_BRIGHTNESS_MAX, "fade steps", LEDZ_BRIGHTNESS_MAX, step);
+#else
+#ifdef LEDZ_BAM_SUPPORT
+    // BAM quantizes the duty cycle with LEDZ_BAM_BITS and a value changed in the middle
+    // of a period mixes the bit planes of the old and new values
+    const double tolerance = 50.0 / PERIOD_TICKS;
+    const uint32_t slack = PERIOD_TICKS / 2;
+#elif defined(LEDZ_DITHER_SUPPORT)
+    // the dithering follows the curve without rounding, a period can have one tick more
+    // than the next one
+    const double tolerance = 50.0 / PERIOD_TICKS;
+    const uint32_t slack = 1;
+#else
+    const double tolerance = 0.0;
+    const uint32_t slack = 0;
+#endif
+
+    // measure a window of about one minute multiple of the PWM period
+    uint32_t window = SIM_TICKS(60000) / PERIOD_TICKS * PERIOD_TICKS;
+    double measured = 100.0 * sim_high_time(pwm, from, from + window) / window;
+    check(fabs(measured - expected) <= tolerance, "internal PWM duty (%)", expected, measured);
+
+    // the time on must rise period by period along the fade and stop at the maximum
+    uint32_t fade_end = SIM_TICKS(FADE_RATE * LEDZ_BRIGHTNESS_MAX + 1000);
+    uint32_t previous = 0;
+    int fade_ok = 1;
+    for (uint32_t t = 0; t + PERIOD_TICKS <= fade_end; t += PERIOD_TICKS)
+    {
+        uint32_t high = sim_high_time(fade, t, t + PERIOD_TICKS);
+        if (high + slack < previous)
+            fade_ok = 0;
+
+        previous = high;
+    }
+
+    check(fade_ok, "fade slope", 1, fade_ok);
+
+    expected = 100.0 * cie1931[LEDZ_BRIGHTNESS_MAX] / LEDZ_PWM_MAX;
+    measured = 100.0 * sim_high_time(fade, fade_end, fade_end + window) / window;
+    check(fabs(measured - expected) <= tolerance, "fade final duty (%)", expected, measured);
+#endif
+
+    if (sim_write_vcd("06-waveform.vcd") || sim_write_trace("06-waveform.trace"))
+    {
+        printf("failed to write the waveform files\n");
+        errors++;
+    }
+
+    return errors ? 1 : 0;
+}
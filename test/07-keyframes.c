@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include "sim.h"
+#include "check.h"
+
+#ifdef LEDZ_BAM_SUPPORT
+#define PERIOD_TICKS    ((1 << LEDZ_BAM_BITS) - 1)
+#else
+#define PERIOD_TICKS    LEDZ_PWM_MAX
+#endif
+
+#ifdef LEDZ_PLAYER_SUPPORT
+// played 3 times: 100ms on and 200ms off
+static const ledz_keyframe_t heartbeat[] = {
+    {LEDZ_RED, LEDZ_BRIGHTNESS_MAX, 100, LEDZ_STEP},
+    {LEDZ_RED, 0, 200, LEDZ_STEP},
+};
+
+// played forever: ramp up in 500ms, hold for 200ms, ramp down in 500ms and hold for 200ms
+static const ledz_keyframe_t breathing[] = {
+    {LEDZ_GREEN, LEDZ_BRIGHTNESS_MAX, 500, LEDZ_LINEAR},
+    {LEDZ_GREEN, LEDZ_BRIGHTNESS_MAX, 200, LEDZ_STEP},
+    {LEDZ_GREEN, 0, 500, LEDZ_LINEAR},
+    {LEDZ_GREEN, 0, 200, LEDZ_STEP},
+};
+
+#ifdef LEDZ_GPIO_PWM
+// led fully on or off according the last change before the given time in ms, the GPIO
+// is set instead of the hardware PWM when the duty cycle is min or max
+static int sim_level(int channel, uint32_t ms)
+{
+    int level = -1;
+
+    for (unsigned int i = 0; i < sim_events_count && sim_events[i].tick < SIM_TICKS(ms); i++)
+    {
+        sim_event_t *event = &sim_events[i];
+        if (event->channel != channel)
+            continue;
+
+        if (event->kind == SIM_SET)
+            level = event->value;
+        else
+            level = event->value == LEDZ_PWM_MAX ? 1 : event->value == 0 ? 0 : -1;
+    }
+
+    return level;
+}
+#else
+// led fully on or off during a PWM period which starts at the given time in ms
+static int sim_level(int channel, uint32_t ms)
+{
+    uint32_t high = sim_high_time(channel, SIM_TICKS(ms), SIM_TICKS(ms) + PERIOD_TICKS);
+    return high == PERIOD_TICKS ? 1 : high == 0 ? 0 : -1;
+}
+#endif
+#endif
+
+int main(void)
+{
+#ifndef LEDZ_PLAYER_SUPPORT
+    printf("skipped: LEDZ_PLAYER_SUPPORT is not defined\n");
+    return 0;
+#else
+    ledz_t* led = ledz_create(LEDZ_2COLOR,
+        (const ledz_color_t []){LEDZ_RED, LEDZ_GREEN}, (const int []){1, 0, 1, 1});
+
+    int red = sim_channel(1, 0);
+    int green = sim_channel(1, 1);
+
+    ledz_play(led, heartbeat, 2, 3);
+    ledz_play(led, breathing, 4, 0);
+    sim_run(SIM_TICKS(4000));
+
+    // the second call replaces the sequence of the led, play it in another object
+    ledz_t* led2 = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED},
+                               (const int []){2, 0});
+    ledz_play(led2, heartbeat, 2, 3);
+
+    uint32_t start = sim_ticks;
+    sim_run(SIM_TICKS(2000));
+
+    int beat = sim_channel(2, 0);
+    // the first keyframe starts immediately, the others in the 1ms flag
+    uint32_t period = sim_period(beat, start, sim_ticks);
+    check(period + SIM_TICKS(1) > SIM_TICKS(300) && period <= SIM_TICKS(300), "heartbeat period");
+    check(sim_high_time(beat, start, sim_ticks) == 3 * SIM_TICKS(100) - 1, "heartbeat time on");
+
+    // the sequence of the red led was replaced before the end of the first keyframe
+    check(sim_high_time(red, 0, start) == start, "replaced sequence");
+
+    // the breathing reaches the keyframes brightness at the end of each ramp
+    int breathing_ok = 1;
+    for (uint32_t t = 0; t + 1400 <= 4000; t += 1400)
+    {
+        if (sim_level(green, t + 550) != 1 || sim_level(green, t + 1250) != 0)
+            breathing_ok = 0;
+    }
+    check(breathing_ok, "breathing levels");
+
+    // a stopped sequence does not change the led anymore, neither its ramps
+    ledz_play(led, 0, 0, 0);
+    ledz_brightness(led, LEDZ_GREEN, 0);
+    start = sim_ticks;
+    sim_run(SIM_TICKS(2000));
+    check(sim_high_time(green, start, sim_ticks) == 0, "stopped sequence");
+
+    // the heartbeat has ended and nothing else is pending
+    check(ledz_next_event_us() == LEDZ_NO_EVENT, "no pending events");
+
+    sim_write_vcd("07-keyframes.vcd");
+
+    return errors ? 1 : 0;
+#endif
+}
@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include "sim.h"
+#include "check.h"
+
+#define MEMBERS     2
+
+#ifdef LEDZ_GROUP_SUPPORT
+// all members must have the same transitions of the first one inside of the window
+static int in_phase(const int *channels, int count, int kind, uint32_t from, uint32_t to)
+{
+    int ok = 1;
+    unsigned int edges[MEMBERS] = {0};
+
+    for (unsigned int i = 0; i < sim_events_count; i++)
+    {
+        sim_event_t *event = &sim_events[i];
+        if (event->tick < from || event->tick >= to || event->kind != kind)
+            continue;
+
+        for (int j = 0; j < count; j++)
+        {
+            if (event->channel == channels[j])
+                edges[j]++;
+        }
+
+        // the transition of the first member must be repeated by the others in the same tick
+        if (event->channel == channels[0])
+        {
+            for (int j = 1; j < count; j++)
+            {
+                int found = 0;
+                for (unsigned int k = 0;
+                     k < sim_events_count && sim_events[k].tick <= event->tick; k++)
+                {
+                    if (sim_events[k].tick == event->tick && sim_events[k].channel == channels[j] &&
+                        sim_events[k].kind == kind && sim_events[k].value == event->value)
+                        found = 1;
+                }
+
+                ok = ok && found;
+            }
+        }
+    }
+
+    for (int j = 1; j < count; j++)
+        ok = ok && edges[j] == edges[0] && edges[0] > 0;
+
+    return ok;
+}
+#endif
+
+int main(void)
+{
+#ifndef LEDZ_GROUP_SUPPORT
+    printf("skipped: LEDZ_GROUP_SUPPORT is not defined\n");
+    return 0;
+#else
+    // members of different objects which are started at different times, the default
+    // amount of instances fits the group and two objects
+    ledz_group_t *group = ledz_group_create();
+    ledz_t *leds[MEMBERS];
+    int channels[MEMBERS];
+
+    for (int i = 0; i < MEMBERS; i++)
+    {
+        leds[i] = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, (const int []){1, i});
+        channels[i] = sim_channel(1, i);
+
+        ledz_group_add(group, leds[i], LEDZ_RED);
+        sim_run(SIM_TICKS(3) + i);
+    }
+
+    ledz_blink(group, LEDZ_RED, 50, 150);
+    uint32_t start = sim_ticks;
+    sim_run(SIM_TICKS(1000));
+
+    check(in_phase(channels, MEMBERS, SIM_SET, start, sim_ticks), "blink in phase");
+    check(sim_period(channels[MEMBERS - 1], start, sim_ticks) == SIM_TICKS(200), "blink period");
+
+#ifdef LEDZ_GPIO_WRITE_PORT
+    // one port write for all members per transition
+    check(sim_port_writes == 2 * 1000 / 200, "batched writes");
+#endif
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+    ledz_brightness(group, LEDZ_RED, LEDZ_BRIGHTNESS_MAX / 3);
+    ledz_fade_in(group, LEDZ_RED, 2, LEDZ_BRIGHTNESS_MAX);
+    start = sim_ticks;
+    sim_run(SIM_TICKS(1000));
+
+#ifdef LEDZ_GPIO_PWM
+    check(in_phase(channels, MEMBERS, SIM_PWM, start, sim_ticks), "PWM in phase");
+#else
+    check(in_phase(channels, MEMBERS, SIM_SET, start, sim_ticks), "PWM in phase");
+#endif
+#endif
+
+    // removed members are not changed by the group anymore
+    ledz_off(group, LEDZ_RED);
+    ledz_group_remove(group, leds[0], LEDZ_RED);
+    ledz_on(group, LEDZ_RED);
+    start = sim_ticks;
+    sim_run(SIM_TICKS(100));
+    check(sim_high_time(channels[0], start, sim_ticks) == 0 &&
+          sim_high_time(channels[1], start, sim_ticks) == sim_ticks - start, "removed member");
+
+    // destroying the group releases the members, which keep their state
+    ledz_group_destroy(group);
+    group = ledz_group_create();
+    ledz_group_add(group, leds[0], LEDZ_RED);
+    ledz_on(group, LEDZ_RED);
+    start = sim_ticks;
+    sim_run(SIM_TICKS(100));
+    check(sim_high_time(channels[0], start, sim_ticks) == sim_ticks - start &&
+          sim_high_time(channels[1], start, sim_ticks) == sim_ticks - start, "destroyed group");
+
+    sim_write_vcd("08-group.vcd");
+
+    return errors ? 1 : 0;
+#endif
+}
@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include "sim.h"
+#include "check.h"
+#include "curves.h"
+
+// tick period of the fast context in us, ticked twice per tick of the default context
+#define FAST_PERIOD     (LEDZ_TICK_PERIOD / 2)
+
+#ifdef LEDZ_CONTEXT_SUPPORT
+// state of the fast context pins, set by its own GPIO function
+static int fast_pins[2];
+static unsigned int fast_writes;
+
+static void fast_set(int port, int pin, int value)
+{
+    (void) port;
+
+    fast_pins[pin] = (value == LEDZ_TURN_ON_VALUE);
+    fast_writes++;
+}
+#endif
+
+int main(void)
+{
+#ifndef LEDZ_CONTEXT_SUPPORT
+    printf("skipped: LEDZ_CONTEXT_SUPPORT is not defined\n");
+    return 0;
+#else
+    // a destroyed led leaves the active set at the next tick, also when it is at its head
+    ledz_t *rgb = ledz_create(LEDZ_3COLOR, (const ledz_color_t []){LEDZ_RED, LEDZ_GREEN, LEDZ_BLUE},
+                              (const int []){0, 0, 0, 1, 0, 2});
+    ledz_blink(rgb, LEDZ_RED | LEDZ_GREEN | LEDZ_BLUE, 50, 50);
+    sim_run(1);
+    ledz_destroy(rgb);
+    sim_run(1);
+
+    // the fast context takes two of the three instances
+    ledz_ctx_t *fast = ledz_ctx_create(2, FAST_PERIOD, &(ledz_gpio_t){.set = fast_set});
+    check(fast != 0, "context created");
+    check(ledz_ctx_create(LEDZ_MAX_INSTANCES, FAST_PERIOD, 0) == 0, "instances not available");
+
+    ledz_t *status = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED},
+                                 (const int []){1, 0});
+    check(ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED},
+                      (const int []){1, 1}) == 0, "default context full");
+
+    ledz_t *backlight = ledz_ctx_led_create(fast, LEDZ_2COLOR,
+        (const ledz_color_t []){LEDZ_RED, LEDZ_GREEN}, (const int []){2, 0, 2, 1});
+    check(backlight != 0, "led created in the context");
+
+    int status_ch = sim_channel(1, 0);
+
+    ledz_blink(status, LEDZ_RED, 50, 50);
+    ledz_blink(backlight, LEDZ_RED, 50, 50);
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+    ledz_brightness(backlight, LEDZ_GREEN, LEDZ_BRIGHTNESS_MAX / 2);
+#endif
+
+    // both contexts run for one second, the blink of the fast context is counted in its ticks
+    unsigned int fast_ticks = 0, blink_high = 0, pwm_high = 0, blink_edges = 0;
+    int last = 0;
+    uint32_t start = sim_ticks;
+    while (sim_ticks - start < SIM_TICKS(1000))
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            ledz_ctx_tick(fast);
+            fast_ticks++;
+
+            blink_high += fast_pins[0];
+            pwm_high += fast_pins[1];
+            blink_edges += fast_pins[0] && !last;
+            last = fast_pins[0];
+        }
+
+        sim_run(1);
+    }
+
+    // the default context is not affected by the other tick
+    check(sim_period(status_ch, start, sim_ticks) == SIM_TICKS(100), "default context period");
+
+    // 50ms on and off in the fast ticks
+    check(blink_edges == 10 && blink_high == 10 * 50000 / FAST_PERIOD, "fast context blink");
+
+#if defined(LEDZ_BRIGHTNESS_SUPPORT) && !defined(LEDZ_GPIO_PWM) && !defined(LEDZ_BAM_SUPPORT)
+    // the internal PWM period is made of the fast ticks
+    unsigned int periods = fast_ticks / LEDZ_PWM_MAX;
+    unsigned int expected = periods * cie1931[LEDZ_BRIGHTNESS_MAX / 2];
+    check(pwm_high + LEDZ_PWM_MAX >= expected && pwm_high <= expected + LEDZ_PWM_MAX,
+          "fast context PWM");
+#else
+    (void) pwm_high;
+#endif
+
+    // the fast context leds are written by its own GPIO function only
+    int foreign = 0;
+    for (unsigned int i = 0; i < sim_events_count; i++)
+    {
+        if (sim_events[i].kind == SIM_SET)
+            foreign |= sim_channels[sim_events[i].channel].port == 2;
+    }
+    check(!foreign && fast_writes > 0, "context GPIO function");
+
+    // the tickless functions see only the leds of the context
+    ledz_off(status, LEDZ_RED);
+    sim_run(1);
+    check(ledz_next_event_us() == LEDZ_NO_EVENT && ledz_ctx_next_event_us(fast) != LEDZ_NO_EVENT,
+          "tickless per context");
+
+    // destroyed instances return to the context which owns them
+    ledz_destroy(backlight);
+    check(ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED},
+                      (const int []){1, 1}) == 0, "instances kept by the context");
+    backlight = ledz_ctx_led_create(fast, LEDZ_2COLOR,
+        (const ledz_color_t []){LEDZ_RED, LEDZ_GREEN}, (const int []){2, 0, 2, 1});
+    check(backlight != 0, "instances reused");
+
+    // a destroyed context gives its instances back to the default context
+    ledz_blink(backlight, LEDZ_RED, 50, 50);
+    ledz_ctx_tick(fast);
+    check(ledz_ctx_destroy(fast) == -1, "context with leds kept");
+    ledz_destroy(backlight);
+    check(ledz_ctx_destroy(fast) == 0, "context destroyed");
+
+    ledz_t *led = ledz_create(LEDZ_2COLOR, (const ledz_color_t []){LEDZ_RED, LEDZ_GREEN},
+                              (const int []){1, 1, 1, 2});
+    ledz_blink(led, LEDZ_RED | LEDZ_GREEN, 50, 50);
+    sim_run(SIM_TICKS(1000));
+    check(led != 0 && sim_period(sim_channel(1, 2), sim_ticks - SIM_TICKS(500), sim_ticks) ==
+          SIM_TICKS(100), "instances given back");
+
+    return errors ? 1 : 0;
+#endif
+}
@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "ledz_shard.h"
+
+#define UNUSED_PARAM(var) do { (void)(var); } while (0)
+
+// each shard uses half of its share of instances, the rest covers the cache line alignment
+#define SHARDS          LEDZ_MAX_CONTEXTS
+#define INSTANCES       (LEDZ_MAX_INSTANCES / (SHARDS + 1))
+#define LEDS            (INSTANCES / 2)
+
+// simulated time in ticks
+#define TICKS           20000
+
+void gpio_set(int port, int pin, int value)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(value);
+}
+
+void gpio_pwm(int port, int pin, int duty)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(duty);
+}
+
+void gpio_write_port(int port, uint32_t mask, uint32_t values)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(mask);
+    UNUSED_PARAM(values);
+}
+
+#ifdef LEDZ_SHARD_SUPPORT
+static uint64_t hash = 14695981039346656037ULL;
+static int last_port, order_ok = 1;
+static unsigned int writes;
+
+// the output is hashed in the order written, the shards are written in order within a tick
+static void output(int port, uint32_t a, uint32_t b)
+{
+    uint32_t data[3] = {port, a, b};
+    for (int i = 0; i < 12; i++)
+        hash = (hash ^ ((data[i / 4] >> (i % 4 * 8)) & 0xFF)) * 1099511628211ULL;
+
+    if (port < last_port)
+        order_ok = 0;
+
+    last_port = port;
+    writes++;
+}
+
+static void output_set(int port, int pin, int value)
+{
+    output(port, pin, value);
+}
+
+static void output_pwm(int port, int pin, int duty)
+{
+    output(port, pin, duty | 0x10000);
+}
+
+static void output_write_port(int port, uint32_t mask, uint32_t values)
+{
+    output(port, mask, values);
+}
+
+// run the same leds with the given amount of threads and return the output hash
+static int run(unsigned int threads, uint64_t *result)
+{
+    int fds[2];
+    if (pipe(fds))
+        return -1;
+
+    // the shards can only be started once, so each run has its own process
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fds[0]);
+
+        // a failed start releases the shards, so the next one can succeed
+        if (ledz_shard_start(SHARDS, LEDZ_MAX_INSTANCES + 1, threads, LEDZ_TICK_PERIOD, 0) != -1 ||
+            ledz_shard_ctx(0))
+            _exit(4);
+
+        // a start failing after some contexts were created destroys them
+        if (ledz_shard_start(SHARDS + 1, INSTANCES, threads, LEDZ_TICK_PERIOD, 0) != -1)
+            _exit(5);
+
+        if (ledz_shard_start(SHARDS, INSTANCES, threads, LEDZ_TICK_PERIOD,
+                             &(ledz_gpio_t){output_set, output_pwm, output_write_port}))
+            _exit(1);
+
+        // skewed load: the first shard is full of busy leds, the others have a few
+        for (int i = 0; i < SHARDS; i++)
+        {
+            for (int j = 0; j < (i == 0 ? LEDS : 2); j++)
+            {
+                ledz_t *led = ledz_ctx_led_create(ledz_shard_ctx(i), LEDZ_1COLOR,
+                    (const ledz_color_t []){LEDZ_RED}, (const int []){i, j});
+
+                ledz_blink(led, LEDZ_RED, 1 + j % 7, 1 + (i + j) % 5);
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+                if (j % 2)
+                    ledz_brightness(led, LEDZ_RED, (j * 13) % LEDZ_BRIGHTNESS_MAX);
+#endif
+
+                // apply the commands if the queue is enabled, before it gets full
+                last_port = 0;
+                ledz_shard_tick();
+            }
+        }
+
+        for (int i = 0; i < TICKS; i++)
+        {
+            last_port = 0;
+            ledz_shard_tick();
+        }
+
+        ledz_shard_stop();
+
+        if (!order_ok || writes == 0 || ledz_shard_dropped())
+            _exit(2);
+
+        if (write(fds[1], &hash, sizeof(hash)) != sizeof(hash))
+            _exit(3);
+
+        _exit(0);
+    }
+
+    close(fds[1]);
+    int status = -1;
+    int ok = read(fds[0], result, sizeof(*result)) == sizeof(*result);
+    close(fds[0]);
+    waitpid(pid, &status, 0);
+
+    return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+#endif
+
+int main(void)
+{
+#ifndef LEDZ_SHARD_SUPPORT
+    printf("skipped: LEDZ_SHARD_SUPPORT is not defined\n");
+    return 0;
+#else
+    uint64_t reference, result;
+    int errors = 0;
+
+    if (run(1, &reference))
+    {
+        printf("1 thread: FAIL\n");
+        return 1;
+    }
+
+    // the output must be the same of a single thread
+    for (unsigned int threads = 2; threads <= 4; threads++)
+    {
+        int ok = run(threads, &result) == 0 && result == reference;
+        printf("%u threads: %s\n", threads, ok ? "OK" : "FAIL");
+
+        if (!ok)
+            errors++;
+    }
+
+    return errors ? 1 : 0;
+#endif
+}
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "ledz_linux.h"
+#include "check.h"
+
+#define UNUSED_PARAM(var) do { (void)(var); } while (0)
+
+// blink of 10ms on and off, counted in ticks
+#define BLINK_MS        10
+#define BLINK_TICKS     (2 * BLINK_MS * 1000 / LEDZ_TICK_PERIOD)
+
+// time the tick thread is blocked to cause an overrun
+#define STALL_US        (20 * LEDZ_TICK_PERIOD)
+
+void gpio_set(int port, int pin, int value)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(value);
+}
+
+void gpio_pwm(int port, int pin, int duty)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(pin);
+    UNUSED_PARAM(duty);
+}
+
+void gpio_write_port(int port, uint32_t mask, uint32_t values)
+{
+    UNUSED_PARAM(port);
+    UNUSED_PARAM(mask);
+    UNUSED_PARAM(values);
+}
+
+#ifdef LEDZ_LINUX_SUPPORT
+static ledz_event_t events[4096];
+static ledz_memory_t memory = {events, sizeof(events) / sizeof(events[0]), 0, 0};
+static ledz_backend_t mock;
+static int stall = 1;
+
+// memory backend which blocks the tick thread once
+static void stall_set(void *data, int port, int pin, int value)
+{
+    if (stall && ledz_linux_ticks() > 0)
+    {
+        stall = 0;
+        usleep(STALL_US);
+    }
+
+    mock.set(data, port, pin, value);
+}
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+#endif
+
+int main(void)
+{
+#ifndef LEDZ_LINUX_SUPPORT
+    printf("skipped: LEDZ_LINUX_SUPPORT is not defined\n");
+    return 0;
+#else
+    ledz_t *led = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED},
+                              (const int []){1, 0});
+
+    ledz_backend_memory(&mock, &memory);
+    ledz_backend_t backend = {stall_set, 0, &memory};
+
+    ledz_blink(led, LEDZ_RED, BLINK_MS, BLINK_MS);
+
+    uint64_t start = now_us();
+    check(ledz_linux_start(&(ledz_linux_config_t){.backend = &backend}) == 0, "runtime started");
+    check(ledz_linux_start(0) != 0, "runtime already running");
+
+    usleep(200000);
+    ledz_linux_stop();
+    uint64_t elapsed = now_us() - start;
+
+    // the missed ticks are run when the thread wakes up, so the ticks follow the clock
+    uint64_t ticks = ledz_linux_ticks(), expected = elapsed / LEDZ_TICK_PERIOD;
+    check(ledz_linux_overruns() >= STALL_US / LEDZ_TICK_PERIOD - 1, "overrun detected");
+    check(ticks <= expected + 1 && ticks + expected / 20 + 10 >= expected, "ticks caught up");
+
+#ifndef LEDZ_GPIO_WRITE_PORT
+    // the blink period is kept in ticks, even around the overrun
+    unsigned int periods = 0, wrong = 0;
+    uint64_t last = 0;
+    for (unsigned int i = 0; i < memory.count; i++)
+    {
+        if (events[i].value != LEDZ_TURN_ON_VALUE)
+            continue;
+
+        if (last)
+        {
+            periods++;
+            wrong += (events[i].tick - last != BLINK_TICKS);
+        }
+
+        last = events[i].tick;
+    }
+    check(periods > 0 && wrong == 0 && memory.dropped == 0, "blink period in ticks");
+#endif
+
+    // the file backend writes a line per change, here to a pipe
+    int fds[2];
+    if (pipe(fds))
+        return 1;
+
+    ledz_backend_file(&backend, fds[1]);
+    check(ledz_linux_start(&(ledz_linux_config_t){.backend = &backend, .max_catchup = 1}) == 0,
+          "runtime restarted");
+
+    ledz_off(led, LEDZ_RED);
+    ledz_on(led, LEDZ_RED);
+    ledz_linux_stop();
+    close(fds[1]);
+
+    char text[256] = {0};
+    if (read(fds[0], text, sizeof(text) - 1) < 0)
+        return 1;
+
+    char expected_line[32];
+    snprintf(expected_line, sizeof(expected_line), "set 1 0 %d\n", LEDZ_TURN_ON_VALUE);
+    check(strstr(text, expected_line) != 0, "file backend");
+
+    return errors ? 1 : 0;
+#endif
+}
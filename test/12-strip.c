@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ledz_strip.h"
+#include "check.h"
+
+#define PIXELS      37
+#define LONG_PIXELS 100
+#define ROUNDS      200
+
+#ifdef LEDZ_STRIP_SUPPORT
+static uint8_t colors[PIXELS * 4], frame[LEDZ_STRIP_FRAME_SIZE(LEDZ_SK6812, PIXELS)];
+static uint32_t dirty[LEDZ_STRIP_DIRTY_SIZE(PIXELS)];
+
+// reference encoder, bit by bit from the datasheets
+static uint8_t reference[sizeof(frame)];
+static unsigned int bit_pos;
+
+static void put_bit(int bit)
+{
+    if (bit)
+        reference[bit_pos / 8] |= 0x80 >> (bit_pos % 8);
+
+    bit_pos++;
+}
+
+static void put_byte(uint8_t byte)
+{
+    for (int i = 7; i >= 0; i--)
+        put_bit((byte >> i) & 1);
+}
+
+static void encode_reference(ledz_strip_type_t type, const uint8_t *rgbw, uint8_t brightness)
+{
+    memset(reference, 0, sizeof(reference));
+    bit_pos = 0;
+
+    if (type == LEDZ_APA102)
+    {
+        put_byte(0); put_byte(0); put_byte(0); put_byte(0);
+
+        for (int i = 0; i < PIXELS; i++)
+        {
+            put_byte(0xE0 | brightness);
+            put_byte(rgbw[i * 3 + 2]);
+            put_byte(rgbw[i * 3 + 1]);
+            put_byte(rgbw[i * 3 + 0]);
+        }
+
+        return;
+    }
+
+    // GRB or GRBW, each bit sent as 110 (one) or 100 (zero)
+    int channels = type == LEDZ_SK6812 ? 4 : 3;
+    static const int order[] = {1, 0, 2, 3};
+    for (int i = 0; i < PIXELS; i++)
+    {
+        for (int j = 0; j < channels; j++)
+        {
+            uint8_t byte = rgbw[i * channels + order[j]];
+            for (int k = 7; k >= 0; k--)
+            {
+                put_bit(1);
+                put_bit((byte >> k) & 1);
+                put_bit(0);
+            }
+        }
+    }
+}
+
+// random changes through the PWM function, only the changed pixels are encoded again
+static void test_type(ledz_strip_type_t type, const char *name)
+{
+    static uint8_t expected[PIXELS * 4];
+    ledz_strip_t strip;
+    char what[64];
+
+    ledz_strip_init(&strip, 1, type, PIXELS, colors, dirty, frame);
+    memset(expected, 0, sizeof(expected));
+
+    int ok = 1, count_ok = 1;
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        uint8_t changed[PIXELS] = {0};
+        unsigned int changed_count = 0;
+
+        for (int i = 0, n = rand() % 8; i < n; i++)
+        {
+            int pin = rand() % (PIXELS * strip.channels);
+            int duty = rand() % (LEDZ_PWM_MAX + 1);
+            uint8_t value = (duty * 255 + LEDZ_PWM_MAX / 2) / LEDZ_PWM_MAX;
+
+            ledz_strip_pwm(1, pin, duty);
+
+            if (expected[pin] != value)
+            {
+                expected[pin] = value;
+                changed_count += !changed[pin / strip.channels];
+                changed[pin / strip.channels] = 1;
+            }
+        }
+
+        if (type == LEDZ_APA102 && round == ROUNDS / 2)
+        {
+            ledz_strip_brightness(&strip, 7);
+            changed_count = PIXELS;
+        }
+
+        count_ok &= (ledz_strip_encode(&strip) == changed_count);
+
+        encode_reference(type, expected, strip.brightness);
+        ok &= (memcmp(frame, reference, strip.frame_size) == 0);
+    }
+
+    snprintf(what, sizeof(what), "%s frame", name);
+    check(ok, what);
+
+    snprintf(what, sizeof(what), "%s dirty pixels", name);
+    check(count_ok, what);
+}
+#endif
+
+int main(void)
+{
+#ifndef LEDZ_STRIP_SUPPORT
+    printf("skipped: LEDZ_STRIP_SUPPORT is not defined\n");
+    return 0;
+#else
+    test_type(LEDZ_WS2812, "WS2812");
+    test_type(LEDZ_SK6812, "SK6812");
+    test_type(LEDZ_APA102, "APA102");
+
+    // a RGB led as the pixel 2 of a strip in the port 0
+    static uint8_t led_colors[LONG_PIXELS * 3];
+    static uint8_t led_frame[LEDZ_STRIP_FRAME_SIZE(LEDZ_WS2812, LONG_PIXELS)];
+    static uint32_t led_dirty[LEDZ_STRIP_DIRTY_SIZE(LONG_PIXELS)];
+    ledz_strip_t strip;
+    ledz_strip_init(&strip, 0, LEDZ_WS2812, LONG_PIXELS, led_colors, led_dirty, led_frame);
+
+    ledz_t *led = ledz_create(LEDZ_3COLOR, (const ledz_color_t []){LEDZ_RED, LEDZ_GREEN, LEDZ_BLUE},
+                              (const int []){0, 6, 0, 7, 0, 8});
+
+    ledz_on(led, LEDZ_RED | LEDZ_BLUE);
+    check(ledz_strip_encode(&strip) == 1 && led_colors[6] == 255 && led_colors[7] == 0 &&
+          led_colors[8] == 255, "led on");
+
+    ledz_off(led, LEDZ_RED);
+    check(ledz_strip_encode(&strip) == 1 && led_colors[6] == 0 && led_colors[8] == 255, "led off");
+
+    check(ledz_strip_encode(&strip) == 0, "nothing to encode");
+
+    ledz_destroy(led);
+
+    // the pins of the pixel 90 are past 255
+    ledz_t *far = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_GREEN},
+                              (const int []){0, 90 * 3 + LEDZ_STRIP_GREEN});
+    ledz_on(far, LEDZ_GREEN);
+    check(ledz_strip_encode(&strip) == 1 && led_colors[271] == 255,
+          "pin past 255");
+
+    // the pins of the last pixel must fit in 16 bits
+    ledz_strip_t big;
+    check(ledz_strip_init(&big, 1, LEDZ_WS2812, LEDZ_STRIP_MAX_PIXELS(LEDZ_WS2812) + 1,
+                          NULL, NULL, NULL) == -1 &&
+          ledz_strip_init(&big, 1, LEDZ_SK6812, LEDZ_STRIP_MAX_PIXELS(LEDZ_SK6812) + 1,
+                          NULL, NULL, NULL) == -1, "strip too long");
+
+    // the port and pin out of range are rejected
+    check(!ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, (const int []){256, 0}) &&
+          !ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, (const int []){0, 65536}) &&
+          !ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, (const int []){0, -1}),
+          "port and pin range");
+
+    return errors ? 1 : 0;
+#endif
+}
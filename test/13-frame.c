@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include "sim.h"
+#include "check.h"
+
+#ifdef LEDZ_FRAMED_MODE
+// amount of events in the window and if all of them happened in the same tick
+static unsigned int events_in(uint32_t from, uint32_t to, int *same_tick)
+{
+    unsigned int count = 0;
+    uint32_t tick = 0;
+
+    *same_tick = 1;
+    for (unsigned int i = 0; i < sim_events_count; i++)
+    {
+        if (sim_events[i].tick < from || sim_events[i].tick >= to)
+            continue;
+
+        if (count++ == 0)
+            tick = sim_events[i].tick;
+        else if (sim_events[i].tick != tick)
+            *same_tick = 0;
+    }
+
+    return count;
+}
+#endif
+
+int main(void)
+{
+#ifndef LEDZ_FRAMED_MODE
+    printf("skipped: LEDZ_FRAMED_MODE is not defined\n");
+    return 0;
+#else
+    ledz_t *rgb = ledz_create(LEDZ_3COLOR, (const ledz_color_t []){LEDZ_RED, LEDZ_GREEN, LEDZ_BLUE},
+                              (const int []){1, 0, 1, 1, 1, 2});
+
+    int green = sim_channel(1, 1), same_tick;
+
+    // nothing happens before the commit
+    uint32_t start = sim_ticks;
+    ledz_on(rgb, LEDZ_RED);
+    ledz_on(rgb, LEDZ_GREEN);
+    ledz_on(rgb, LEDZ_BLUE);
+    sim_run(10);
+    check(events_in(start, sim_ticks, &same_tick) == 0, "frame kept until commit");
+
+    // the three channels change in the same tick
+    start = sim_ticks;
+    ledz_commit();
+    sim_run(10);
+    check(events_in(start, sim_ticks, &same_tick) == 3 && same_tick, "frame applied at once");
+
+    // a led changed and restored in the same frame is not written
+    start = sim_ticks;
+    ledz_off(rgb, LEDZ_RED);
+    ledz_on(rgb, LEDZ_RED);
+    ledz_toggle(rgb, LEDZ_GREEN);
+    ledz_commit();
+    sim_run(10);
+    check(events_in(start, sim_ticks, &same_tick) == 1 &&
+          sim_events[sim_events_count - 1].channel == green, "redundant writes skipped");
+
+    // a frame filling the queue, the red led ends in the same state
+    start = sim_ticks;
+    for (int i = 0; i < LEDZ_QUEUE_SIZE; i++)
+        ledz_toggle(rgb, LEDZ_RED);
+    int result = ledz_commit();
+    sim_run(10);
+    check(result == 0 && events_in(start, sim_ticks, &same_tick) == 0, "full frame");
+
+    // a frame bigger than the queue is split and reported, the split part is applied by the
+    // next tick, the commands written before it are dropped and the rest is applied after
+    // the commit
+    start = sim_ticks;
+    unsigned int dropped = ledz_queue_dropped();
+    ledz_toggle(rgb, LEDZ_RED);
+    for (int i = 0; i < LEDZ_QUEUE_SIZE - 1; i++)
+        ledz_on(rgb, LEDZ_BLUE);
+    ledz_toggle(rgb, LEDZ_GREEN);
+    check(ledz_queue_dropped() == dropped + 1, "command dropped while the queue is full");
+
+    sim_run(1);
+    ledz_toggle(rgb, LEDZ_GREEN);
+    result = ledz_commit();
+    sim_run(10);
+    check(result == -1 && events_in(start, sim_ticks, &same_tick) == 2 && !same_tick &&
+          ledz_queue_dropped() == dropped + 1 && ledz_commit() == 0, "split frame");
+
+    // the tick changes are written as usual
+    start = sim_ticks;
+    ledz_blink(rgb, LEDZ_BLUE, 10, 10);
+    ledz_commit();
+    sim_run(SIM_TICKS(100));
+    check(events_in(start, sim_ticks, &same_tick) >= 9, "blink after commit");
+
+    // a command queued before the destroy is not applied to a new led taking the instance
+    ledz_destroy(rgb);
+    ledz_t *led = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, (const int []){2, 0});
+    ledz_on(led, LEDZ_RED);
+    ledz_destroy(led);
+    led = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, (const int []){2, 1});
+    start = sim_ticks;
+    ledz_commit();
+    sim_run(10);
+    check(led && events_in(start, sim_ticks, &same_tick) == 0,
+          "command of a destroyed led dropped");
+    ledz_destroy(led);
+
+    return errors ? 1 : 0;
+#endif
+}
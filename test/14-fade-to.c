@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include "sim.h"
+#include "check.h"
+#include "curves.h"
+
+#if defined(LEDZ_EASING_SUPPORT) && defined(LEDZ_GPIO_PWM)
+static ledz_t *led;
+static int channel;
+
+// duty cycle written until the given tick and tick of the last write
+static int duty_at(uint32_t tick, uint32_t *last)
+{
+    int duty = -1;
+
+    for (unsigned int i = 0; i < sim_events_count && sim_events[i].tick <= tick; i++)
+    {
+        if (sim_events[i].channel == channel && sim_events[i].kind == SIM_PWM)
+        {
+            duty = sim_events[i].value;
+            if (last)
+                *last = sim_events[i].tick;
+        }
+    }
+
+    return duty;
+}
+
+// fade from zero and return the duty cycle in the middle of the fade, the end is checked
+static int fade(unsigned int target, uint16_t duration, ledz_easing_t easing, int *on_time)
+{
+    ledz_brightness(led, LEDZ_RED, 0);
+    sim_run(SIM_TICKS(5));
+
+    uint32_t start = sim_ticks, last = 0;
+    ledz_fade_to(led, LEDZ_RED, target, duration, easing);
+    sim_run(SIM_TICKS(duration + 50));
+
+    // the last change happens in the last ms of the fade
+    int end = duty_at(sim_ticks, &last);
+    *on_time = end == cie1931[target] &&
+               last >= start + SIM_TICKS(duration - 1) && last <= start + SIM_TICKS(duration + 1);
+
+    return duty_at(start + SIM_TICKS(duration / 2), 0);
+}
+#endif
+
+int main(void)
+{
+#if !defined(LEDZ_EASING_SUPPORT) || !defined(LEDZ_GPIO_PWM)
+    printf("skipped: LEDZ_EASING_SUPPORT and LEDZ_GPIO_PWM are not defined\n");
+    return 0;
+#else
+    led = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, (const int []){1, 0});
+    channel = sim_channel(1, 0);
+
+    // the duration doesn't depend on the distance and can be faster than 1 unit per ms
+    int ok_long, ok_short, ok_fast;
+    fade(LEDZ_BRIGHTNESS_MAX, 400, LEDZ_EASE_LINEAR, &ok_long);
+    fade(LEDZ_BRIGHTNESS_MAX / 10, 400, LEDZ_EASE_LINEAR, &ok_short);
+    fade(LEDZ_BRIGHTNESS_MAX, LEDZ_BRIGHTNESS_MAX / 5, LEDZ_EASE_LINEAR, &ok_fast);
+    check(ok_long && ok_short, "duration independent of distance");
+    check(ok_fast, "faster than 1 unit per ms");
+
+    // in the middle of the fade: ease in is behind, ease out ahead and the symmetric ones at half
+    int ok[5];
+    int linear = fade(LEDZ_BRIGHTNESS_MAX, 400, LEDZ_EASE_LINEAR, &ok[0]);
+    int in = fade(LEDZ_BRIGHTNESS_MAX, 400, LEDZ_EASE_IN, &ok[1]);
+    int out = fade(LEDZ_BRIGHTNESS_MAX, 400, LEDZ_EASE_OUT, &ok[2]);
+    int in_out = fade(LEDZ_BRIGHTNESS_MAX, 400, LEDZ_EASE_IN_OUT, &ok[3]);
+    int sine = fade(LEDZ_BRIGHTNESS_MAX, 400, LEDZ_EASE_SINE, &ok[4]);
+    check(ok[0] && ok[1] && ok[2] && ok[3] && ok[4], "easing curves reach the target");
+    check(in < linear && linear < out, "ease in and out");
+    check(in_out >= linear - 2 && in_out <= linear + 2 && sine >= linear - 2 && sine <= linear + 2,
+          "symmetric easing");
+
+    // fade down and stopped by ledz_set
+    int ok_down;
+    ledz_brightness(led, LEDZ_RED, LEDZ_BRIGHTNESS_MAX);
+    sim_run(1);
+    uint32_t start = sim_ticks;
+    ledz_fade_to(led, LEDZ_RED, 0, 100, LEDZ_EASE_SINE);
+    sim_run(SIM_TICKS(150));
+    ok_down = duty_at(sim_ticks, 0) == 0 && duty_at(start + SIM_TICKS(50), 0) > 0;
+    check(ok_down, "fade down");
+
+    ledz_fade_to(led, LEDZ_RED, LEDZ_BRIGHTNESS_MAX, 100, LEDZ_EASE_LINEAR);
+    sim_run(SIM_TICKS(10));
+    ledz_off(led, LEDZ_RED);
+    sim_run(1);
+    unsigned int events = sim_events_count;
+    sim_run(SIM_TICKS(200));
+    check(events == sim_events_count && ledz_next_event_us() == LEDZ_NO_EVENT,
+          "stopped by ledz_set");
+
+    return errors ? 1 : 0;
+#endif
+}
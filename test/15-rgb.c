@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <math.h>
+#include "sim.h"
+#include "check.h"
+#include "curves.h"
+
+#if defined(LEDZ_RGB_SUPPORT) && defined(LEDZ_GPIO_PWM)
+static ledz_t *led;
+static int channels[3];
+
+// apply the commands if the queue is enabled
+static void apply(void)
+{
+#ifdef LEDZ_FRAMED_MODE
+    ledz_commit();
+#endif
+    sim_run(1);
+}
+
+// last duty cycle written to the channel, the GPIO set is 0 or LEDZ_PWM_MAX
+static int duty_of(int channel)
+{
+    for (unsigned int i = sim_events_count; i > 0; i--)
+    {
+        sim_event_t *event = &sim_events[i - 1];
+        if (event->channel == channel)
+            return event->kind == SIM_PWM ? event->value : event->value * LEDZ_PWM_MAX;
+    }
+
+    return 0;
+}
+
+// the duty cycle of the component, tolerance in brightness units
+static int duty_ok(int channel, double component, int tolerance)
+{
+    int level = lround(component * LEDZ_BRIGHTNESS_MAX / 255);
+    int min = level - tolerance < 0 ? 0 : level - tolerance;
+    int max = level + tolerance > LEDZ_BRIGHTNESS_MAX ? LEDZ_BRIGHTNESS_MAX : level + tolerance;
+    int duty = duty_of(channel);
+
+    return duty >= cie1931[min] && duty <= cie1931[max];
+}
+
+// reference HSV to RGB conversion
+static void hsv_to_rgb(unsigned int hue, unsigned int s, unsigned int v, double rgb[3])
+{
+    double h = hue * 6.0 / 65536, offsets[3] = {5, 3, 1};
+
+    for (int c = 0; c < 3; c++)
+    {
+        double k = fmod(offsets[c] + h, 6);
+        double f = fmax(0, fmin(fmin(k, 4 - k), 1));
+        rgb[c] = v - v * (s / 255.0) * f;
+    }
+}
+#endif
+
+int main(void)
+{
+#if !defined(LEDZ_RGB_SUPPORT) || !defined(LEDZ_GPIO_PWM)
+    printf("skipped: LEDZ_RGB_SUPPORT and LEDZ_GPIO_PWM are not defined\n");
+    return 0;
+#else
+    led = ledz_create(LEDZ_3COLOR, (const ledz_color_t []){LEDZ_RED, LEDZ_GREEN, LEDZ_BLUE},
+                      (const int []){1, 0, 1, 1, 1, 2});
+    for (int c = 0; c < 3; c++)
+        channels[c] = sim_channel(1, c);
+
+    // each channel is written once with its own component
+    unsigned int events = sim_events_count;
+    ledz_set_rgb(led, 255, 128, 10);
+    apply();
+    check(sim_events_count - events == 3 && duty_ok(channels[0], 255, 0) &&
+          duty_ok(channels[1], 128, 1) && duty_ok(channels[2], 10, 1), "rgb");
+
+    // the white balance scales the components
+    ledz_rgb_balance(255, 128, 0);
+    ledz_set_rgb(led, 255, 255, 255);
+    apply();
+    check(duty_ok(channels[0], 255, 0) && duty_ok(channels[1], 128, 1) &&
+          duty_ok(channels[2], 0, 0), "white balance");
+    ledz_rgb_balance(255, 255, 255);
+
+    // integer HSV conversion against the reference
+    int hsv_ok = 1;
+    int tolerance = 2 * LEDZ_BRIGHTNESS_MAX / 255 + 1;
+    for (unsigned int hue = 0; hue < 65536 && hsv_ok; hue += 1111)
+    {
+        for (unsigned int s = 0; s < 256; s += 51)
+        {
+            for (unsigned int v = 0; v < 256; v += 85)
+            {
+                double rgb[3];
+                hsv_to_rgb(hue, s, v, rgb);
+                ledz_set_hsv(led, hue, s, v);
+                apply();
+
+                for (int c = 0; c < 3; c++)
+                    hsv_ok = hsv_ok && duty_ok(channels[c], rgb[c], tolerance);
+            }
+        }
+    }
+    check(hsv_ok, "hsv");
+
+    ledz_set_hsv(led, LEDZ_HUE(120), 255, 255);
+    apply();
+    check(duty_ok(channels[0], 0, 0) && duty_ok(channels[1], 255, 0) &&
+          duty_ok(channels[2], 0, 0), "pure green");
+
+    // the batch writes the same of one call per color, across several chunks
+#ifdef LEDZ_COMMAND_QUEUE
+    enum {COUNT = LEDZ_QUEUE_SIZE};
+#else
+    enum {COUNT = LEDZ_RGB_CHUNK * 2 + 3};
+#endif
+    ledz_t *leds[COUNT];
+    ledz_rgb_t rgb[COUNT];
+    ledz_hsv_t hsv[COUNT];
+    for (int i = 0; i < COUNT; i++)
+    {
+        leds[i] = led;
+        rgb[i] = (ledz_rgb_t){i * 7, 255 - i * 5, i * 3};
+        hsv[i] = (ledz_hsv_t){i * 2000, 255 - i, 40 + i * 4};
+    }
+
+    sim_events_count = 0;
+    for (int i = 0; i < COUNT; i++)
+        ledz_set_rgb(led, rgb[i].red, rgb[i].green, rgb[i].blue);
+    apply();
+    for (int i = 0; i < COUNT; i++)
+        ledz_set_hsv(led, hsv[i].hue, hsv[i].saturation, hsv[i].value);
+    apply();
+
+    unsigned int count = sim_events_count;
+    sim_event_t *single = malloc(count * sizeof(sim_event_t));
+    for (unsigned int i = 0; i < count; i++)
+        single[i] = sim_events[i];
+
+    sim_events_count = 0;
+    ledz_set_rgb_batch(leds, rgb, COUNT);
+    apply();
+    ledz_set_hsv_batch(leds, hsv, COUNT);
+    apply();
+
+    int batch_ok = count == sim_events_count;
+    for (unsigned int i = 0; i < count && batch_ok; i++)
+    {
+        batch_ok = single[i].channel == sim_events[i].channel &&
+                   single[i].kind == sim_events[i].kind && single[i].value == sim_events[i].value;
+    }
+    check(batch_ok, "batch");
+    free(single);
+
+    return errors ? 1 : 0;
+#endif
+}
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "ledz.h"
+
+#if defined(LEDZ_BRIGHTNESS_SUPPORT) && !defined(LEDZ_BAM_SUPPORT) && \
+    !defined(LEDZ_DITHER_SUPPORT) && !defined(LEDZ_COMMAND_QUEUE) && !defined(LEDZ_GPIO_WRITE_PORT)
+#include "ledz.hpp"
+
+#define TICKS   20000
+
+// GPIO calls of the C library and of the pool, recorded in separated logs
+typedef struct EVENT_T {
+    int tick, port, pin, kind, value;
+    unsigned int order;
+} event_t;
+
+typedef struct LOG_T {
+    event_t events[TICKS * 3];
+    unsigned int count;
+} log_t;
+
+enum {SET, PWM};
+
+static log_t c_log, pool_log, *current;
+static int ticks;
+
+static void record(int port, int pin, int kind, int value)
+{
+    if (current->count < sizeof(current->events) / sizeof(event_t))
+    {
+        current->events[current->count] = event_t{ticks, port, pin, kind, value, current->count};
+        current->count++;
+    }
+}
+
+extern "C" void gpio_set(int port, int pin, int value)
+{
+    record(port, pin, SET, value);
+}
+
+extern "C" void gpio_pwm(int port, int pin, int duty)
+{
+    record(port, pin, PWM, duty);
+}
+
+extern "C" void gpio_write_port(int port, uint32_t mask, uint32_t values)
+{
+    (void) port;
+    (void) mask;
+    (void) values;
+}
+
+// the C library writes the active LEDs in any order, so the events are sorted by pin
+static int compare(const void *a, const void *b)
+{
+    const event_t *x = (const event_t *) a, *y = (const event_t *) b;
+
+    if (x->pin != y->pin)
+        return x->pin - y->pin;
+
+    // qsort is not stable, the events of the same pin keep the recorded order
+    return (int) x->order - (int) y->order;
+}
+
+static void sort(log_t *log)
+{
+    qsort(log->events, log->count, sizeof(event_t), compare);
+}
+#endif
+
+int main(void)
+{
+#if !defined(LEDZ_BRIGHTNESS_SUPPORT) || defined(LEDZ_BAM_SUPPORT) || \
+    defined(LEDZ_DITHER_SUPPORT) || defined(LEDZ_COMMAND_QUEUE) || defined(LEDZ_GPIO_WRITE_PORT)
+    printf("skipped: the pool requires LEDZ_BRIGHTNESS_SUPPORT without BAM, dithering, queue or "
+           "port writes\n");
+    return 0;
+#else
+    const ledz_color_t colors[] = {LEDZ_RED};
+    ledz_t *c_leds[3];
+    for (int i = 0; i < 3; i++)
+    {
+        const int pins[] = {1, i};
+        c_leds[i] = ledz_create(LEDZ_1COLOR, colors, pins);
+    }
+
+    // blinking with brightness, fading, and only on/off
+    ledz::Pool<ledz::Config,
+        ledz::Pin<1, 0, ledz::BLINK | ledz::BRIGHTNESS>,
+        ledz::Pin<1, 1, ledz::BRIGHTNESS | ledz::FADE>,
+        ledz::Pin<1, 2, 0>> pool;
+
+    for (ticks = 0; ticks < TICKS; ticks++)
+    {
+        // same commands to both
+        current = &c_log;
+        switch (ticks)
+        {
+            case 10:
+                ledz_brightness(c_leds[0], LEDZ_RED, 30);
+                ledz_blink(c_leds[0], LEDZ_RED, 3, 5);
+                break;
+            case 20: ledz_fade_in(c_leds[1], LEDZ_RED, 2, 60); break;
+            case 9000: ledz_fade_out(c_leds[1], LEDZ_RED, 1, 10); break;
+            case 15000:
+                ledz_blink(c_leds[0], LEDZ_RED, 0, 0);
+                ledz_brightness(c_leds[0], LEDZ_RED, 75);
+                break;
+            case 18000: ledz_off(c_leds[0], LEDZ_RED); break;
+        }
+        if (ticks % 37 == 0)
+            ledz_toggle(c_leds[2], LEDZ_RED);
+        ledz_tick();
+
+        current = &pool_log;
+        switch (ticks)
+        {
+            case 10: pool.brightness<0>(30); pool.blink<0>(3, 5); break;
+            case 20: pool.fade_in<1>(2, 60); break;
+            case 9000: pool.fade_out<1>(1, 10); break;
+            case 15000: pool.blink<0>(0, 0); pool.brightness<0>(75); break;
+            case 18000: pool.off<0>(); break;
+        }
+        if (ticks % 37 == 0)
+            pool.toggle<2>();
+        pool.tick();
+    }
+
+    sort(&c_log);
+    sort(&pool_log);
+
+    int ok = c_log.count == pool_log.count && c_log.count > 0;
+    for (unsigned int i = 0; ok && i < c_log.count; i++)
+    {
+        event_t *a = &c_log.events[i], *b = &pool_log.events[i];
+        ok = a->tick == b->tick && a->port == b->port && a->pin == b->pin &&
+             a->kind == b->kind && a->value == b->value;
+
+        if (!ok)
+        {
+            printf("event %u: tick %d pin %d kind %d value %d, "
+                   "pool: tick %d pin %d kind %d value %d\n",
+                   i, a->tick, a->pin, a->kind, a->value, b->tick, b->pin, b->kind, b->value);
+        }
+    }
+
+    printf("%-40s %s\n", "pool same as C library", ok ? "OK" : "FAIL");
+
+    return ok ? 0 : 1;
+#endif
+}
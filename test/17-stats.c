@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <string.h>
+#include "sim.h"
+#include "check.h"
+
+#ifdef LEDZ_STATS_SUPPORT
+// apply the commands if the queue is enabled
+static void apply(void)
+{
+#ifdef LEDZ_FRAMED_MODE
+    ledz_commit();
+#endif
+    sim_run(1);
+}
+
+// amount of events of the channel recorded from the given index
+static unsigned int events_of(int channel, int kind, unsigned int from)
+{
+    unsigned int count = 0;
+
+    for (unsigned int i = from; i < sim_events_count; i++)
+    {
+        if (sim_events[i].channel == channel && sim_events[i].kind == kind)
+            count++;
+    }
+
+    return count;
+}
+
+// statistics expected from the GPIO calls recorded in the ticks [start, sim_ticks)
+static void expected(uint32_t start, unsigned int from, ledz_stats_t *stats)
+{
+    uint64_t total = 0;
+
+    *stats = (ledz_stats_t) {0};
+    stats->cycles_min = UINT32_MAX;
+
+    for (uint32_t tick = start; tick < sim_ticks; tick++)
+    {
+        uint32_t cycles = 0;
+        for (; from < sim_events_count && sim_events[from].tick == tick; from++)
+            cycles += SIM_CALL_CYCLES;
+
+        if (cycles < stats->cycles_min)
+            stats->cycles_min = cycles;
+        if (cycles > stats->cycles_max)
+            stats->cycles_max = cycles;
+        if (cycles > LEDZ_TICK_PERIOD * LEDZ_STATS_CYCLES_PER_US)
+            stats->overruns++;
+
+        stats->histogram[31 - __builtin_clz(cycles | 1)]++;
+        total += cycles;
+        stats->ticks++;
+    }
+
+    stats->cycles_avg = total / stats->ticks;
+}
+#endif
+
+int main(void)
+{
+#ifndef LEDZ_STATS_SUPPORT
+    printf("skipped: LEDZ_STATS_SUPPORT is not defined\n");
+    return 0;
+#else
+    ledz_t *rgb = ledz_create(LEDZ_3COLOR, (const ledz_color_t []){LEDZ_RED, LEDZ_GREEN, LEDZ_BLUE},
+                              (const int []){1, 0, 1, 1, 1, 2});
+    int red = sim_channel(1, 0), green = sim_channel(1, 1);
+
+    // the three channels toggle in the same tick
+    ledz_blink(rgb, LEDZ_RED | LEDZ_GREEN | LEDZ_BLUE, 10, 10);
+    apply();
+
+    ledz_stats_reset();
+    uint32_t start = sim_ticks;
+    unsigned int from = sim_events_count;
+    sim_run(SIM_TICKS(1000));
+
+    ledz_stats_t stats, reference;
+    ledz_stats_get(&stats);
+    expected(start, from, &reference);
+
+    check(stats.ticks == SIM_TICKS(1000), "ticks");
+    check(stats.cycles_max > 0 && stats.cycles_min == reference.cycles_min &&
+          stats.cycles_avg == reference.cycles_avg && stats.cycles_max == reference.cycles_max,
+          "min, avg and max");
+    check(memcmp(stats.histogram, reference.histogram, sizeof(stats.histogram)) == 0, "histogram");
+    check(stats.overruns == reference.overruns, "overruns");
+
+    ledz_led_stats_t writes, all;
+    ledz_stats_led(rgb, LEDZ_RED, &writes);
+    ledz_stats_led(rgb, LEDZ_RED | LEDZ_GREEN | LEDZ_BLUE, &all);
+    check(writes.gpio_writes == events_of(red, SIM_SET, from) &&
+          writes.pwm_writes == events_of(red, SIM_PWM, from) && writes.gpio_writes == 100 &&
+          all.gpio_writes == 3 * writes.gpio_writes && all.pwm_writes == 3 * writes.pwm_writes,
+          "writes per led");
+
+    // brightness of the green channel, written by the hardware or the internal PWM
+    ledz_off(rgb, LEDZ_RED | LEDZ_GREEN | LEDZ_BLUE);
+    apply();
+    ledz_stats_reset();
+    from = sim_events_count;
+    ledz_brightness(rgb, LEDZ_GREEN, 50);
+    apply();
+    sim_run(SIM_TICKS(10));
+
+    ledz_stats_led(rgb, LEDZ_GREEN, &writes);
+    check(writes.gpio_writes == events_of(green, SIM_SET, from) &&
+          writes.pwm_writes == events_of(green, SIM_PWM, from) &&
+          writes.gpio_writes + writes.pwm_writes > 0, "pwm writes");
+
+    // the tickless mode measures the ticks which change a led, one every 10ms
+    ledz_off(rgb, LEDZ_RED | LEDZ_GREEN | LEDZ_BLUE);
+    ledz_blink(rgb, LEDZ_RED, 10, 10);
+    apply();
+    ledz_stats_reset();
+    ledz_advance(1000000);
+
+    ledz_stats_get(&stats);
+    ledz_stats_led(rgb, LEDZ_RED, &writes);
+    check(stats.ticks == 100 && writes.gpio_writes == 100 && stats.cycles_min > 0, "advance");
+
+    ledz_stats_reset();
+    ledz_stats_get(&stats);
+    ledz_stats_led(rgb, LEDZ_GREEN, &writes);
+    check(stats.ticks == 0 && stats.cycles_max == 0 && stats.histogram[0] == 0 &&
+          writes.gpio_writes == 0 && writes.pwm_writes == 0, "reset");
+
+    return errors ? 1 : 0;
+#endif
+}
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include "sim.h"
+#include "check.h"
+#include "curves.h"
+
+#ifdef LEDZ_PWM_STAGGER
+#define LEDS    (LEDZ_MAX_INSTANCES < SIM_MAX_CHANNELS ? LEDZ_MAX_INSTANCES : SIM_MAX_CHANNELS)
+
+// ticks of difference allowed in the time on of 10 periods, the dithering adds up to one
+// tick to each period
+#ifdef LEDZ_DITHER_SUPPORT
+#define SLACK   10
+#else
+#define SLACK   1
+#endif
+
+// apply the commands if the queue is enabled
+static void apply(void)
+{
+#ifdef LEDZ_FRAMED_MODE
+    ledz_commit();
+#endif
+    sim_run(1);
+}
+
+// maximum of GPIO writes made by a tick in the window [from, to)
+static unsigned int max_writes(uint32_t from, uint32_t to)
+{
+    unsigned int max = 0, count = 0;
+    uint32_t tick = from;
+
+    for (unsigned int i = 0; i < sim_events_count; i++)
+    {
+        sim_event_t *event = &sim_events[i];
+        if (event->tick < from || event->tick >= to || event->kind != SIM_SET)
+            continue;
+
+        if (event->tick != tick)
+        {
+            tick = event->tick;
+            count = 0;
+        }
+
+        if (++count > max)
+            max = count;
+    }
+
+    return max;
+}
+#endif
+
+int main(void)
+{
+#ifndef LEDZ_PWM_STAGGER
+    printf("skipped: LEDZ_PWM_STAGGER is not defined\n");
+    return 0;
+#else
+    ledz_t *leds[LEDS];
+    for (int i = 0; i < LEDS; i++)
+        leds[i] = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, (const int []){1, i});
+
+    // the brightness is set from the last to the first led, one tick apart, so the phase
+    // offsets cancel out and all leds would switch in the same ticks
+    unsigned int value = LEDZ_BRIGHTNESS_MAX / 2;
+    for (int i = LEDS - 1; i >= 0; i--)
+    {
+        ledz_brightness(leds[i], LEDZ_RED, value);
+        apply();
+    }
+
+    // let the phases settle
+    sim_run(4 * LEDZ_PWM_MAX);
+
+    uint32_t from = sim_ticks, to = from + 10 * LEDZ_PWM_MAX;
+    sim_run(to - from);
+
+    unsigned int writes = max_writes(from, to);
+    printf("leds: %d, max edges: %d, writes per tick: %u\n", LEDS, LEDZ_PWM_MAX_EDGES, writes);
+    check(writes > 0 && writes <= LEDZ_PWM_MAX_EDGES, "edges per tick");
+
+    int period_ok = 1, duty_ok = 1;
+    for (int i = 0; i < LEDS; i++)
+    {
+        int channel = sim_channel(1, i);
+        uint32_t high = sim_high_time(channel, from, to);
+
+        period_ok = period_ok && sim_period(channel, from, to) == LEDZ_PWM_MAX;
+        duty_ok = duty_ok && high + SLACK >= 10u * cie1931[value] &&
+                  high <= 10u * cie1931[value] + SLACK;
+    }
+    check(period_ok, "period");
+    check(duty_ok, "duty cycle");
+
+    return errors ? 1 : 0;
+#endif
+}
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <math.h>
+#include "sim.h"
+#include "check.h"
+
+#ifdef LEDZ_DITHER_SUPPORT
+// periods of the measurement window
+#define PERIODS     512
+
+// apply the commands if the queue is enabled
+static void apply(void)
+{
+#ifdef LEDZ_FRAMED_MODE
+    ledz_commit();
+#endif
+    sim_run(1);
+}
+
+// duty cycle in ticks of the CIE 1931 curve without rounding, the same formula of tools/curves
+static double cie1931_exact(unsigned int value)
+{
+    double l = (double) value / LEDZ_BRIGHTNESS_MAX * 100.0;
+    double y = l <= 8.0 ? l / 902.3 : pow((l + 16.0) / 116.0, 3.0);
+
+    return y * LEDZ_PWM_MAX;
+}
+#endif
+
+int main(void)
+{
+#ifndef LEDZ_DITHER_SUPPORT
+    printf("skipped: LEDZ_DITHER_SUPPORT is not defined\n");
+    return 0;
+#else
+    // the lowest values are rounded to zero or one tick by the curve
+    const unsigned int values[] = {1, 7, LEDZ_BRIGHTNESS_MAX / 2};
+    ledz_t *leds[3];
+
+    for (int i = 0; i < 3; i++)
+    {
+        leds[i] = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, (const int []){1, i});
+        ledz_brightness(leds[i], LEDZ_RED, values[i]);
+    }
+    apply();
+
+    sim_run(4 * LEDZ_PWM_MAX);
+
+    uint32_t from = sim_ticks, to = from + PERIODS * LEDZ_PWM_MAX;
+    sim_run(to - from);
+
+    // the average follows the curve within the residual resolution and the error left
+    // in the accumulator at the end of the window
+    int average_ok = 1;
+    for (int i = 0; i < 3; i++)
+    {
+        double average = (double) sim_high_time(sim_channel(1, i), from, to) / PERIODS;
+        double exact = cie1931_exact(values[i]);
+
+        printf("value: %u, duty: %.4f, exact: %.4f\n", values[i], average, exact);
+        average_ok = average_ok && fabs(average - exact) <= 1.0 / 256 + 1.0 / PERIODS;
+    }
+    check(average_ok, "long-run average duty");
+
+    check(sim_period(sim_channel(1, 2), from, to) == LEDZ_PWM_MAX, "period");
+
+    return errors ? 1 : 0;
+#endif
+}
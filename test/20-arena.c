@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include "sim.h"
+#include "check.h"
+
+#if defined(LEDZ_ARENA_SUPPORT) && LEDZ_MAX_INSTANCES >= 9
+#define INSTANCES   9
+
+// bytes skipped at most to align the instances, a new cache line or the instance alignment
+#ifdef LEDZ_CACHE_LINE
+#define ALIGN       LEDZ_CACHE_LINE
+#define SLACK       (LEDZ_CACHE_LINE - 1)
+#else
+#define ALIGN       8
+#define SLACK       (ledz_instance_size() - 1)
+#endif
+
+// room for the instances of the test, the arena is misaligned on purpose
+static uint8_t arena[8192] __attribute__((aligned(ALIGN)));
+
+static const ledz_color_t colors[] = {LEDZ_RED, LEDZ_GREEN, LEDZ_BLUE};
+
+// apply the commands if the queue is enabled
+static void apply(void)
+{
+#ifdef LEDZ_FRAMED_MODE
+    ledz_commit();
+#endif
+    sim_run(1);
+}
+
+static ledz_t* create(ledz_type_t type, int port)
+{
+    const int pins[] = {port, 0, port, 1, port, 2};
+    return ledz_create(type, colors, pins);
+}
+#endif
+
+int main(void)
+{
+#if !defined(LEDZ_ARENA_SUPPORT) || LEDZ_MAX_INSTANCES < 9
+    printf("skipped: LEDZ_ARENA_SUPPORT is not defined or LEDZ_MAX_INSTANCES < 9\n");
+    return 0;
+#else
+    // one byte less than the instances and the alignment need
+    size_t bytes = INSTANCES * ledz_instance_size() + SLACK;
+    check(ledz_create(LEDZ_1COLOR, colors, (const int []){0, 0}) == NULL &&
+          ledz_init(arena + 1, bytes) == INSTANCES &&
+          ledz_init(arena, sizeof(arena)) == 0, "init");
+
+    ledz_t *rgb[3];
+    for (int i = 0; i < 3; i++)
+        rgb[i] = create(LEDZ_3COLOR, i);
+    check(rgb[0] && rgb[1] && rgb[2] && create(LEDZ_1COLOR, 9) == NULL, "fill the arena");
+
+    ledz_handle_t handle = ledz_handle(rgb[1]);
+    check(ledz_resolve(handle) == rgb[1] && ledz_resolve(0) == NULL && ledz_handle(NULL) == 0,
+          "resolve");
+
+    ledz_destroy(rgb[1]);
+    ledz_destroy(rgb[1]);
+    check(ledz_resolve(handle) == NULL, "stale handle");
+
+    // the destroyed RGB is reused by the smaller objects, its first instance first
+    ledz_t *single = create(LEDZ_1COLOR, 3), *dual = create(LEDZ_2COLOR, 4);
+    check(single == rgb[1] && dual && ledz_resolve(handle) == NULL &&
+          ledz_resolve(ledz_handle(single)) == single &&
+          ledz_resolve(ledz_handle(dual)) == dual && create(LEDZ_1COLOR, 9) == NULL,
+          "reuse of the destroyed object");
+
+    // a reused instance drives its new GPIO
+    unsigned int from = sim_events_count;
+    ledz_on(dual, LEDZ_GREEN);
+    apply();
+    check(sim_events_count == from + 1 && sim_events[from].channel == sim_channel(4, 1) &&
+          sim_events[from].value == 1, "reused instance");
+
+    // a RGB LED takes the instances of three destroyed 1 color LEDs which are not adjacent
+    ledz_destroy(rgb[0]);
+    ledz_t *a = create(LEDZ_1COLOR, 5), *b = create(LEDZ_1COLOR, 6), *c = create(LEDZ_1COLOR, 7);
+    check(a == rgb[0] && b && c && create(LEDZ_1COLOR, 9) == NULL, "objects by instance");
+
+    ledz_destroy(a);
+    ledz_destroy(c);
+    ledz_destroy(single);
+    ledz_t *merged = create(LEDZ_3COLOR, 8);
+    check(merged && create(LEDZ_1COLOR, 9) == NULL, "free instances reused by a RGB LED");
+
+    from = sim_events_count;
+    ledz_on(merged, LEDZ_BLUE);
+    apply();
+    check(sim_events_count == from + 1 && sim_events[from].channel == sim_channel(8, 2) &&
+          sim_events[from].value == 1, "RGB LED on free instances");
+
+    return errors ? 1 : 0;
+#endif
+}
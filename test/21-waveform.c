@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <string.h>
+#include "sim.h"
+
+#if defined(LEDZ_WAVEFORM_SUPPORT) && defined(LEDZ_GPIO_PWM)
+#include "ledz_waveform.h"
+#include "check.h"
+
+#define TICKS   20000
+
+// pins of the LEDs, each one is on/off, blinking, with brightness or fading
+#define PINS    3
+
+static ledz_waveform_t wave;
+static uint32_t table[LEDZ_WAVEFORM_SIZE];
+
+// ticks on of each channel given by the tick output, -1 before the first GPIO change
+static int reference[SIM_MAX_CHANNELS];
+static unsigned int fed;
+
+// apply the commands if the queue is enabled
+static void commit(void)
+{
+#ifdef LEDZ_FRAMED_MODE
+    ledz_commit();
+#endif
+}
+
+// table built from scratch, one port with the given ticks on per pin (-1 is not rendered)
+static void render(uint32_t *words, const int *on_ticks, int pins)
+{
+    memset(words, 0, LEDZ_WAVEFORM_SIZE * sizeof(uint32_t));
+
+    for (int pin = 0; pin < pins; pin++)
+    {
+        if (on_ticks[pin] < 0)
+            continue;
+
+        uint32_t bit = 1u << pin;
+        for (int i = 0; i < LEDZ_WAVEFORM_SIZE; i++)
+        {
+            int on = i < on_ticks[pin];
+            words[i] |= LEDZ_TURN_ON_VALUE == on ? LEDZ_WAVEFORM_WORD(bit, 0) :
+                                                   LEDZ_WAVEFORM_WORD(0, bit);
+        }
+    }
+}
+
+// the DMA transfer of a word to the set/reset register
+static uint32_t play(uint32_t port, uint32_t word)
+{
+    for (int pin = 0; pin < LEDZ_WAVEFORM_PINS; pin++)
+    {
+        uint32_t bit = 1u << pin;
+        if (word & LEDZ_WAVEFORM_WORD(bit, 0))
+            port |= bit;
+        else if (word & LEDZ_WAVEFORM_WORD(0, bit))
+            port &= ~bit;
+    }
+
+    return port;
+}
+
+// runs the ticks passing their GPIO changes to the table, as the GPIO macros would do, and
+// compares the port driven by the table with the tick output
+static int run(uint32_t ticks)
+{
+    static uint32_t port;
+    int ok = 1;
+
+    while (ticks--)
+    {
+        uint32_t tick = sim_ticks;
+        sim_run(1);
+
+        for (; fed < sim_events_count; fed++)
+        {
+            sim_event_t *event = &sim_events[fed];
+            sim_channel_t *channel = &sim_channels[event->channel];
+
+            if (event->kind == SIM_SET)
+            {
+                int value = event->value ? LEDZ_TURN_ON_VALUE : !LEDZ_TURN_ON_VALUE;
+                ledz_waveform_set(channel->port, channel->pin, value);
+                reference[event->channel] = event->value ? LEDZ_PWM_MAX : 0;
+            }
+            else
+            {
+                ledz_waveform_pwm(channel->port, channel->pin, event->value);
+                reference[event->channel] = event->value;
+            }
+        }
+
+        int slot = tick % LEDZ_WAVEFORM_SIZE;
+        port = play(port, table[slot]);
+
+        for (int i = 0; i < PINS; i++)
+        {
+            int channel = sim_channel(0, i);
+            if (reference[channel] < 0)
+                continue;
+
+            int on = ((port >> i) & 1) == LEDZ_TURN_ON_VALUE;
+            if (on != (slot < reference[channel]))
+            {
+                if (ok)
+                    printf("tick %u pin %d: table %d, tick output %d\n", tick, i, on,
+                           reference[channel]);
+                ok = 0;
+            }
+        }
+    }
+
+    return ok;
+}
+#endif
+
+int main(void)
+{
+#if !defined(LEDZ_WAVEFORM_SUPPORT) || !defined(LEDZ_GPIO_PWM)
+    printf("skipped: LEDZ_WAVEFORM_SUPPORT or LEDZ_GPIO_PWM is not defined\n");
+    return 0;
+#else
+    uint32_t words[LEDZ_WAVEFORM_SIZE];
+    check(ledz_waveform_init(&wave, LEDZ_MAX_WAVEFORMS, table) == -1 &&
+          ledz_waveform_init(&wave, 0, table) == 0, "init");
+
+    // incremental updates against the table rebuilt from scratch, the ports without a table
+    // and the pins out of range are ignored
+    int on_ticks[LEDZ_WAVEFORM_PINS];
+    memset(on_ticks, 0xFF, sizeof(on_ticks));
+    int incremental_ok = 1;
+    srand(25);
+    for (int i = 0; i < 2000 && incremental_ok; i++)
+    {
+        int pin = rand() % LEDZ_WAVEFORM_PINS, duty = rand() % (LEDZ_PWM_MAX + 3) - 1;
+        if (rand() % 4 == 0)
+        {
+            int value = rand() % 2;
+            ledz_waveform_set(0, pin, value);
+            on_ticks[pin] = value == LEDZ_TURN_ON_VALUE ? LEDZ_PWM_MAX : 0;
+        }
+        else
+        {
+            ledz_waveform_pwm(0, pin, duty);
+            on_ticks[pin] = duty < 0 ? 0 : duty > LEDZ_PWM_MAX ? LEDZ_PWM_MAX : duty;
+        }
+
+        ledz_waveform_pwm(1, pin, duty);
+        ledz_waveform_pwm(0, LEDZ_WAVEFORM_PINS, duty);
+
+        render(words, on_ticks, LEDZ_WAVEFORM_PINS);
+        incremental_ok = memcmp(words, table, sizeof(words)) == 0;
+    }
+    check(incremental_ok, "incremental update");
+
+    // the pin after the last one would write the reset part of the word, e.g. the pin 16 is
+    // the reset of the pin 0 in the BSRR layout
+    memcpy(words, table, sizeof(words));
+    ledz_waveform_set(0, LEDZ_WAVEFORM_PINS, LEDZ_TURN_ON_VALUE);
+    ledz_waveform_pwm(0, LEDZ_WAVEFORM_PINS, LEDZ_PWM_MAX / 2);
+    ledz_waveform_pwm(0, -1, LEDZ_PWM_MAX / 2);
+    check(memcmp(words, table, sizeof(words)) == 0, "pins out of range ignored");
+
+    // the LEDs are driven by the tick output, which is played from a new table
+    ledz_waveform_init(&wave, 0, table);
+    for (int i = 0; i < SIM_MAX_CHANNELS; i++)
+        reference[i] = -1;
+
+    ledz_t *leds[PINS];
+    for (int i = 0; i < PINS; i++)
+        leds[i] = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, (const int []){0, i});
+
+    ledz_on(leds[0], LEDZ_RED);
+    ledz_brightness(leds[1], LEDZ_RED, LEDZ_BRIGHTNESS_MAX / 2);
+    ledz_blink(leds[1], LEDZ_RED, 50, 50);
+    ledz_fade_in(leds[2], LEDZ_RED, 1, LEDZ_BRIGHTNESS_MAX);
+    commit();
+
+    int output_ok = run(TICKS / 2);
+
+    ledz_blink(leds[0], LEDZ_RED, 30, 70);
+    ledz_blink(leds[1], LEDZ_RED, 0, 0);
+    ledz_brightness(leds[1], LEDZ_RED, 1);
+    ledz_fade_out(leds[2], LEDZ_RED, 2, 0);
+    commit();
+
+    output_ok = run(TICKS / 2) && output_ok;
+    check(output_ok, "table same as tick output");
+
+    int pins[PINS];
+    for (int i = 0; i < PINS; i++)
+        pins[i] = reference[sim_channel(0, i)];
+    render(words, pins, PINS);
+    check(memcmp(words, table, sizeof(words)) == 0, "table same as rebuilt table");
+
+    return errors ? 1 : 0;
+#endif
+}
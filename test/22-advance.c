@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "sim.h"
+#include "check.h"
+
+// each run starts at a multiple of these ticks, so the 1 ms counter and the BAM cycle of the
+// core are in the same phase in all runs
+#ifdef LEDZ_BAM_SUPPORT
+#define ALIGN       (1000 / LEDZ_TICK_PERIOD * ((1 << LEDZ_BAM_BITS) - 1))
+#else
+#define ALIGN       (1000 / LEDZ_TICK_PERIOD)
+#endif
+
+enum {TICK, FULL_WAIT, PARTIAL_WAIT};
+
+typedef struct LOG_T {
+    unsigned int first, count;
+    uint32_t origin;
+} log_t;
+
+static int mode;
+static uint32_t origin;
+
+// time since the start of the run in us, only used by the tickless runs
+static uint64_t now_us;
+
+// apply the commands if the queue is enabled
+static void commit(void)
+{
+#ifdef LEDZ_FRAMED_MODE
+    ledz_commit();
+#endif
+}
+
+// sleeps until the next event, or a random part of it, as a one-shot timer would do
+static void run(uint32_t ticks)
+{
+    if (mode == TICK)
+    {
+        sim_run(ticks);
+        return;
+    }
+
+    uint64_t end_us = (uint64_t) (sim_ticks - origin + ticks) * LEDZ_TICK_PERIOD;
+    while (now_us < end_us)
+    {
+        uint32_t next = ledz_next_event_us();
+        uint64_t wait = next == LEDZ_NO_EVENT ? end_us - now_us : next > 0 ? next : 1;
+
+        if (mode == PARTIAL_WAIT && rand() % 2)
+            wait = rand() % wait + 1;
+
+        if (wait > end_us - now_us)
+            wait = end_us - now_us;
+
+        // the changes are made by the last tick run by ledz_advance
+        uint32_t ticks_after = (now_us + wait) / LEDZ_TICK_PERIOD;
+        if (ticks_after > 0)
+            sim_ticks = origin + ticks_after - 1;
+
+        ledz_advance(wait);
+
+        now_us += wait;
+        sim_ticks = origin + now_us / LEDZ_TICK_PERIOD;
+    }
+}
+
+// the same commands in each run, the objects are destroyed at the end so the next run gets
+// the same instances
+static log_t scenario(int run_mode)
+{
+    sim_run(ALIGN - sim_ticks % ALIGN);
+
+    log_t log = {sim_events_count, 0, sim_ticks};
+    mode = run_mode;
+    origin = sim_ticks;
+    now_us = 0;
+
+    ledz_t *a = ledz_create(LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED}, (const int []){0, 0});
+    ledz_t *b = ledz_create(LEDZ_2COLOR, (const ledz_color_t []){LEDZ_RED, LEDZ_GREEN},
+                            (const int []){1, 0, 1, 1});
+
+    ledz_on(a, LEDZ_RED);
+    commit();
+    run(100);
+
+    ledz_blink(a, LEDZ_RED, 30, 70);
+    commit();
+    run(1000);
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+    ledz_brightness(b, LEDZ_RED, LEDZ_BRIGHTNESS_MAX * 2 / 5);
+    commit();
+    run(3000);
+
+    // the queued fade out below is applied in a 1ms flag tick, in the middle of the fade in
+    ledz_fade_in(b, LEDZ_GREEN, 3, LEDZ_BRIGHTNESS_MAX * 9 / 10);
+    commit();
+    run(4999);
+
+    ledz_fade_out(b, LEDZ_GREEN, 2, LEDZ_BRIGHTNESS_MAX / 10);
+    ledz_blink(a, LEDZ_RED, 5, 5);
+    commit();
+    run(5000);
+
+    // a rate lowered in the middle of a fade leaves the counter above it, the next step comes
+    // after the 16 bits counter wraps around, the other leds are idle so it is a single skip
+    ledz_off(a, LEDZ_RED);
+    ledz_off(b, LEDZ_RED);
+    ledz_brightness(b, LEDZ_GREEN, 0);
+    ledz_fade_in(b, LEDZ_GREEN, 50, LEDZ_BRIGHTNESS_MAX / 2);
+    commit();
+    run(SIM_TICKS(20));
+
+    ledz_fade_in(b, LEDZ_GREEN, 10, LEDZ_BRIGHTNESS_MAX / 2);
+    commit();
+    run(SIM_TICKS(66000));
+#endif
+
+    ledz_blink(b, LEDZ_RED, 10, 20);
+    commit();
+    run(4000);
+
+    ledz_set(b, LEDZ_RED | LEDZ_GREEN, 0);
+    ledz_toggle(a, LEDZ_RED);
+    commit();
+    run(300);
+
+    ledz_off(a, LEDZ_RED);
+    ledz_blink(a, LEDZ_RED, 0, 5);
+    commit();
+    run(700);
+
+    ledz_destroy(a);
+    ledz_destroy(b);
+
+    log.count = sim_events_count - log.first;
+    return log;
+}
+
+// the LEDs of a tick are written in any order, so the events are sorted by tick and channel
+static int compare(const void *a, const void *b)
+{
+    const sim_event_t *x = (const sim_event_t *) a, *y = (const sim_event_t *) b;
+
+    if (x->tick != y->tick)
+        return x->tick < y->tick ? -1 : 1;
+
+    if (x->channel != y->channel)
+        return x->channel - y->channel;
+
+    return x->value - y->value;
+}
+
+static int same_events(const log_t *a, const log_t *b)
+{
+    if (a->count != b->count || a->count == 0)
+    {
+        printf("events: %u, tickless: %u\n", a->count, b->count);
+        return 0;
+    }
+
+    qsort(&sim_events[a->first], a->count, sizeof(sim_event_t), compare);
+    qsort(&sim_events[b->first], b->count, sizeof(sim_event_t), compare);
+
+    for (unsigned int i = 0; i < a->count; i++)
+    {
+        const sim_event_t *x = &sim_events[a->first + i], *y = &sim_events[b->first + i];
+
+        if (x->tick - a->origin != y->tick - b->origin || x->channel != y->channel ||
+            x->kind != y->kind || x->value != y->value)
+        {
+            printf("event %u: tick %u channel %u value %u, tickless: tick %u channel %u value %u\n",
+                   i, x->tick - a->origin, x->channel, x->value,
+                   y->tick - b->origin, y->channel, y->value);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int main(void)
+{
+    srand(2);
+
+    log_t ticks = scenario(TICK);
+    log_t full = scenario(FULL_WAIT);
+    log_t partial = scenario(PARTIAL_WAIT);
+
+    check(same_events(&ticks, &full), "full waits same as ticks");
+    check(same_events(&ticks, &partial), "partial waits same as ticks");
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include "sim.h"
+#include "check.h"
+
+#if !defined(LEDZ_ARENA_SUPPORT) && !defined(LEDZ_CONTEXT_SUPPORT) && LEDZ_MAX_INSTANCES >= 8
+static const ledz_color_t colors[] = {LEDZ_RED, LEDZ_GREEN, LEDZ_BLUE};
+
+static ledz_t* create(ledz_type_t type, int port)
+{
+    const int pins[] = {port, 0, port, 1, port, 2};
+    return ledz_create(type, colors, pins);
+}
+
+// the led is on at the end of the run
+static int is_on(int port, int pin)
+{
+    return sim_high_time(sim_channel(port, pin), sim_ticks - 1, sim_ticks) == 1;
+}
+#endif
+
+int main(void)
+{
+#if defined(LEDZ_ARENA_SUPPORT) || defined(LEDZ_CONTEXT_SUPPORT) || LEDZ_MAX_INSTANCES < 8
+    printf("skipped: LEDZ_ARENA_SUPPORT or LEDZ_CONTEXT_SUPPORT is defined or "
+           "LEDZ_MAX_INSTANCES < 8\n");
+    return 0;
+#else
+    // fill the pool with 1 color LEDs
+    ledz_t *fill[LEDZ_MAX_INSTANCES];
+    unsigned int filled = 0;
+    while ((fill[filled] = create(LEDZ_1COLOR, 0)))
+        filled++;
+
+    check(filled == LEDZ_MAX_INSTANCES, "pool filled");
+
+    // three free instances that are not adjacent host a RGB LED
+    ledz_destroy(fill[1]);
+    ledz_destroy(fill[4]);
+    ledz_destroy(fill[6]);
+    ledz_t *rgb = create(LEDZ_3COLOR, 1);
+    check(rgb != NULL, "RGB LED takes any free instances");
+    check(create(LEDZ_1COLOR, 2) == NULL, "pool full again");
+
+    // each color drives its own pin
+    ledz_on(rgb, LEDZ_GREEN);
+    sim_run(1);
+    check(!is_on(1, 0) && is_on(1, 1) && !is_on(1, 2), "green on its pin");
+
+    ledz_on(rgb, LEDZ_RED | LEDZ_BLUE);
+    ledz_off(rgb, LEDZ_GREEN);
+    sim_run(1);
+    check(is_on(1, 0) && !is_on(1, 1) && is_on(1, 2), "red and blue on their pins");
+
+    // the instances of the RGB LED are released one by one
+    ledz_destroy(rgb);
+    fill[1] = create(LEDZ_1COLOR, 0);
+    fill[4] = create(LEDZ_2COLOR, 0);
+    check(fill[1] && fill[4] && create(LEDZ_1COLOR, 0) == NULL, "instances released");
+
+    for (unsigned int i = 0; i < filled; i++)
+    {
+        if (i != 6)
+            ledz_destroy(fill[i]);
+    }
+
+    return errors ? 1 : 0;
+#endif
+}
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include "sim.h"
+#include "check.h"
+
+#define ALL     (LEDZ_RED | LEDZ_GREEN | LEDZ_BLUE)
+
+// the led is on during the whole window
+static int always_on(int pin, uint32_t from, uint32_t to)
+{
+    return sim_high_time(sim_channel(0, pin), from, to) == to - from;
+}
+
+int main(void)
+{
+    const ledz_color_t colors[] = {LEDZ_RED, LEDZ_GREEN, LEDZ_BLUE};
+    ledz_t *led = ledz_create(LEDZ_3COLOR, colors, (const int []){0, 0, 0, 1, 0, 2});
+
+    // turning on blinking LEDs stops the blink of every color, not only the first one
+    ledz_blink(led, ALL, 10, 10);
+    sim_run(SIM_TICKS(25));
+    ledz_on(led, ALL);
+    sim_run(1);
+
+    uint32_t from = sim_ticks;
+    sim_run(SIM_TICKS(100));
+    check(always_on(0, from, sim_ticks) && always_on(1, from, sim_ticks) &&
+          always_on(2, from, sim_ticks), "set stops the blink of all colors");
+    check(ledz_next_event_us() == LEDZ_NO_EVENT, "set leaves no pending work");
+
+    // the blink with zero time stops every color and keeps its state
+    ledz_blink(led, ALL, 10, 10);
+    sim_run(SIM_TICKS(15));
+    ledz_blink(led, ALL, 0, 0);
+    sim_run(1);
+
+    unsigned int events = sim_events_count;
+    sim_run(SIM_TICKS(100));
+    check(sim_events_count == events, "zero time stops the blink of all colors");
+    check(ledz_next_event_us() == LEDZ_NO_EVENT, "zero time leaves no pending work");
+
+    ledz_destroy(led);
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include "sim.h"
+#include "check.h"
+
+#if defined(LEDZ_GPIO_WRITE_PORT) && defined(LEDZ_CONTEXT_SUPPORT)
+// rising edges written by the set function of the context
+static unsigned int ctx_edges;
+static int ctx_value;
+
+static void ctx_set(int port, int pin, int value)
+{
+    (void) port;
+    (void) pin;
+
+    ctx_edges += (value == LEDZ_TURN_ON_VALUE) && !ctx_value;
+    ctx_value = (value == LEDZ_TURN_ON_VALUE);
+}
+#endif
+
+int main(void)
+{
+#ifndef LEDZ_GPIO_WRITE_PORT
+    printf("skipped: LEDZ_GPIO_WRITE_PORT is not defined\n");
+    return 0;
+#else
+    // a pin in the mask of the port and one past its 32 bits
+    const ledz_color_t red[] = {LEDZ_RED};
+    ledz_t *low = ledz_create(LEDZ_1COLOR, red, (const int []){0, 3});
+    ledz_t *high = ledz_create(LEDZ_1COLOR, red, (const int []){0, 40});
+
+    ledz_blink(low, LEDZ_RED, 50, 50);
+    ledz_blink(high, LEDZ_RED, 50, 50);
+    sim_run(SIM_TICKS(1000));
+
+    int low_pin = sim_channel(0, 3), high_pin = sim_channel(0, 40);
+    check(sim_period(low_pin, 0, sim_ticks) == SIM_TICKS(100) &&
+          sim_high_time(low_pin, 0, sim_ticks) == SIM_TICKS(500), "pin in the mask");
+    check(sim_period(high_pin, 0, sim_ticks) == SIM_TICKS(100) &&
+          sim_high_time(high_pin, 0, sim_ticks) == SIM_TICKS(500), "pin past the mask");
+
+    // only the low pin is grouped in the port writes, the others stay untouched
+    check(sim_port_writes == 1000 / 50 && sim_channels_count == 2, "port writes");
+
+    ledz_destroy(low);
+    ledz_destroy(high);
+
+#ifdef LEDZ_CONTEXT_SUPPORT
+    // a context with only a set function writes its pins with it instead of the port write
+    ledz_ctx_t *ctx = ledz_ctx_create(1, LEDZ_TICK_PERIOD, &(ledz_gpio_t){.set = ctx_set});
+    ledz_t *led = ledz_ctx_led_create(ctx, LEDZ_1COLOR, (const ledz_color_t []){LEDZ_RED},
+                                      (const int []){0, 5});
+    check(ctx && led, "context created");
+
+    unsigned int port_writes = sim_port_writes;
+    ledz_blink(led, LEDZ_RED, 50, 50);
+    for (uint32_t i = 0; i < SIM_TICKS(1000); i++)
+        ledz_ctx_tick(ctx);
+
+    check(ctx_edges == 1000 / 100 && sim_port_writes == port_writes, "set function of the context");
+#endif
+
+    return errors ? 1 : 0;
+#endif
+}
@@ -0,0 +1,25 @@
+/*
+ * Results of the test programs
+ *
+ * check prints one line per test case and counts the failed ones, the program returns a
+ * failure when errors is not zero. The file is included once by each test program, so
+ * everything is static.
+ */
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+// amount of failed test cases
+static int errors;
+
+static inline void check(int ok, const char *what)
+{
+    printf("%-40s %s\n", what, ok ? "OK" : "FAIL");
+
+    if (!ok)
+        errors++;
+}
+
+#endif
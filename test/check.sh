@@ -0,0 +1,78 @@
+#!/bin/sh
+# builds the library and the tests for each configuration and runs the tests of the feature
+# the check fails when a test fails, doesn't build or is skipped by the configuration
+
+MAKE=${MAKE:-make}
+FAILED=
+
+run()
+{
+    config=$1
+    shift
+
+    echo "== ${config:-default}"
+    $MAKE -s -C .. clean > /dev/null
+    $MAKE -s clean > /dev/null
+
+    if ! $MAKE -s -C .. INCS=-Itest CONFIG="$config" > /dev/null; then
+        echo "failed to build the library"
+        FAILED="$FAILED\n  library: $config"
+        return
+    fi
+
+    for test in "$@"; do
+        if ! $MAKE -s CONFIG="$config" $test.bin > /dev/null; then
+            result="failed to build"
+        elif ! output=$(./$test.bin 2>&1); then
+            echo "$output"
+            result="failed"
+        elif echo "$output" | grep -q "^skipped:"; then
+            echo "$output"
+            result="skipped"
+        else
+            result="OK"
+        fi
+
+        printf "%-40s %s\n" $test "$result"
+        [ "$result" = OK ] || FAILED="$FAILED\n  $test: $config"
+    done
+}
+
+PWM="'-DLEDZ_GPIO_PWM(port,pin,duty)=gpio_pwm(port,pin,duty)'"
+STRIP="'-DLEDZ_GPIO_SET(port,pin,value)=ledz_strip_set(port,pin,value)'"
+STRIP="$STRIP '-DLEDZ_GPIO_PWM(port,pin,duty)=ledz_strip_pwm(port,pin,duty)'"
+PORT="'-DLEDZ_GPIO_WRITE_PORT(port,mask,values)=gpio_write_port(port,mask,values)'"
+SHARD="-DLEDZ_SHARD_SUPPORT -DLEDZ_CONTEXT_SUPPORT"
+
+run "" 01-on-off 02-blink 03-tickless 04-duty 06-waveform 16-pool 22-advance 24-set-blink
+run "-DLEDZ_BAM_SUPPORT" 04-duty 06-waveform 22-advance
+run "-DLEDZ_COMMAND_QUEUE" 05-queue-stress
+run "-DLEDZ_PLAYER_SUPPORT" 07-keyframes
+run "-DLEDZ_GROUP_SUPPORT -DLEDZ_MAX_INSTANCES=8" 08-group
+run "$PORT -DLEDZ_GROUP_SUPPORT -DLEDZ_MAX_INSTANCES=8" 08-group 25-port-write
+run "$PORT -DLEDZ_CONTEXT_SUPPORT" 25-port-write
+run "-DLEDZ_CONTEXT_SUPPORT" 09-contexts
+run "$SHARD -DLEDZ_MAX_CONTEXTS=4 -DLEDZ_MAX_INSTANCES=64" 10-shards
+run "-DLEDZ_LINUX_SUPPORT" 02-blink 11-linux
+run "$STRIP -DLEDZ_STRIP_SUPPORT" 12-strip
+run "-DLEDZ_COMMAND_QUEUE -DLEDZ_FRAMED_MODE" 13-frame 22-advance
+run "$PWM -DLEDZ_EASING_SUPPORT" 14-fade-to
+run "$PWM -DLEDZ_RGB_SUPPORT" 15-rgb
+run "-DLEDZ_STATS_SUPPORT '-DLEDZ_STATS_CYCLES()=gpio_cycles()'" 17-stats
+run "-DLEDZ_PWM_STAGGER" 18-stagger 22-advance
+run "-DLEDZ_DITHER_SUPPORT" 19-dither 22-advance
+run "-DLEDZ_ARENA_SUPPORT -DLEDZ_MAX_INSTANCES=9" 20-arena
+run "$PWM -DLEDZ_WAVEFORM_SUPPORT" 21-waveform
+run "-DLEDZ_MAX_INSTANCES=8" 23-fragment
+run "-DLEDZ_DEADLINE_HEAP" 01-on-off 22-advance 24-set-blink
+run "-DLEDZ_DEADLINE_HEAP -DLEDZ_BAM_SUPPORT" 22-advance
+run "-DLEDZ_DEADLINE_HEAP -DLEDZ_COMMAND_QUEUE -DLEDZ_FRAMED_MODE" 13-frame 22-advance
+run "-DLEDZ_DEADLINE_HEAP -DLEDZ_CONTEXT_SUPPORT" 09-contexts
+
+$MAKE -s -C .. clean > /dev/null
+$MAKE -s clean > /dev/null
+
+if [ -n "$FAILED" ]; then
+    printf "failed:$FAILED\n"
+    exit 1
+fi
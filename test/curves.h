@@ -0,0 +1,21 @@
+/*
+ * Brightness curves of the library
+ *
+ * The tables are static in the generated headers, so the tests include the one of the
+ * library build to compute the expected duty cycles.
+ */
+
+#ifndef CURVES_H
+#define CURVES_H
+
+#include "ledz.h"
+
+#ifdef LEDZ_BRIGHTNESS_SUPPORT
+#ifdef LEDZ_BRIGHTNESS_BITS
+#include "ledz_curves_gen.h"
+#else
+#include "ledz_curves.h"
+#endif
+#endif
+
+#endif
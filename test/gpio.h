@@ -0,0 +1,7 @@
+// GPIO functions implemented by the tests and benchmarks
+#include <stdint.h>
+
+void gpio_set(int port, int pin, int value);
+void gpio_pwm(int port, int pin, int duty);
+void gpio_write_port(int port, uint32_t mask, uint32_t values);
+uint32_t gpio_cycles(void);
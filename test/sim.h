@@ -0,0 +1,277 @@
+/*
+ * Virtual clock simulation of the ledz core
+ *
+ * The GPIO functions below record every transition timestamped by a virtual clock which is
+ * advanced by sim_run, so minutes of LED output are simulated as fast as ledz_tick runs.
+ * The recorded transitions can be exported to VCD (e.g. to be viewed in GTKWave) or to a
+ * binary trace, and measured with sim_high_time and sim_period.
+ *
+ * The file is included once by each test program, so everything is static.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "ledz.h"
+
+// maximum of different port/pin pairs recorded
+#define SIM_MAX_CHANNELS    8
+
+// kind of the recorded transitions
+enum {SIM_SET, SIM_PWM};
+
+typedef struct SIM_EVENT_T {
+    uint32_t tick;
+    uint8_t channel, kind;
+    uint16_t value;
+} sim_event_t;
+
+typedef struct SIM_CHANNEL_T {
+    int port, pin;
+} sim_channel_t;
+
+static sim_event_t *sim_events;
+static unsigned int sim_events_count, sim_events_size;
+static sim_channel_t sim_channels[SIM_MAX_CHANNELS];
+static unsigned int sim_channels_count;
+
+// virtual clock in ticks
+static uint32_t sim_ticks;
+
+// virtual cycle counter of the statistics, each GPIO call costs the same amount of cycles
+#define SIM_CALL_CYCLES     40
+static uint32_t sim_cycles;
+
+#define SIM_US(ticks)       ((uint64_t) (ticks) * LEDZ_TICK_PERIOD)
+#define SIM_TICKS(ms)       ((uint32_t) ((ms) * 1000ULL / LEDZ_TICK_PERIOD))
+
+static inline int sim_channel(int port, int pin)
+{
+    for (unsigned int i = 0; i < sim_channels_count; i++)
+    {
+        if (sim_channels[i].port == port && sim_channels[i].pin == pin)
+            return i;
+    }
+
+    if (sim_channels_count == SIM_MAX_CHANNELS)
+    {
+        fprintf(stderr, "sim: too many channels\n");
+        exit(1);
+    }
+
+    sim_channels[sim_channels_count].port = port;
+    sim_channels[sim_channels_count].pin = pin;
+    return sim_channels_count++;
+}
+
+static inline void sim_record(int port, int pin, int kind, int value)
+{
+    if (sim_events_count == sim_events_size)
+    {
+        sim_events_size = sim_events_size ? sim_events_size * 2 : 4096;
+        sim_events = realloc(sim_events, sim_events_size * sizeof(sim_event_t));
+        if (!sim_events)
+        {
+            fprintf(stderr, "sim: out of memory\n");
+            exit(1);
+        }
+    }
+
+    sim_cycles += SIM_CALL_CYCLES;
+
+    sim_event_t *event = &sim_events[sim_events_count++];
+    event->tick = sim_ticks;
+    event->channel = sim_channel(port, pin);
+    event->kind = kind;
+    event->value = value;
+}
+
+void gpio_set(int port, int pin, int value)
+{
+    sim_record(port, pin, SIM_SET, value == LEDZ_TURN_ON_VALUE);
+}
+
+void gpio_pwm(int port, int pin, int duty)
+{
+    sim_record(port, pin, SIM_PWM, duty);
+}
+
+// cycle counter used with: -DLEDZ_STATS_CYCLES()=gpio_cycles()
+uint32_t gpio_cycles(void)
+{
+    return sim_cycles;
+}
+
+// amount of calls of the port write
+static unsigned int sim_port_writes;
+
+void gpio_write_port(int port, uint32_t mask, uint32_t values)
+{
+    sim_port_writes++;
+
+    for (int pin = 0; pin < 32; pin++)
+    {
+        if (mask & ((uint32_t) 1 << pin))
+            gpio_set(port, pin, (values >> pin) & 1);
+    }
+}
+
+static inline void sim_run(uint32_t ticks)
+{
+    while (ticks--)
+    {
+        // the transitions made by the tick are timestamped with the tick start
+        ledz_tick();
+        sim_ticks++;
+    }
+}
+
+// time in ticks which the channel was on inside of the window [from, to)
+static inline uint32_t sim_high_time(int channel, uint32_t from, uint32_t to)
+{
+    uint32_t high = 0, last = from;
+    int state = 0;
+
+    for (unsigned int i = 0; i < sim_events_count && sim_events[i].tick < to; i++)
+    {
+        sim_event_t *event = &sim_events[i];
+        if (event->channel != channel || event->kind != SIM_SET)
+            continue;
+
+        if (event->tick > from)
+        {
+            if (state)
+                high += event->tick - last;
+
+            last = event->tick;
+        }
+
+        state = event->value;
+    }
+
+    if (state)
+        high += to - last;
+
+    return high;
+}
+
+// average period in ticks between the rising edges of the channel inside of the window
+// or zero if less than two edges were found
+static inline uint32_t sim_period(int channel, uint32_t from, uint32_t to)
+{
+    uint32_t first = 0, last = 0, edges = 0;
+    int state = 0;
+
+    for (unsigned int i = 0; i < sim_events_count && sim_events[i].tick < to; i++)
+    {
+        sim_event_t *event = &sim_events[i];
+        if (event->channel != channel || event->kind != SIM_SET)
+            continue;
+
+        if (event->value && !state && event->tick >= from)
+        {
+            if (edges++ == 0)
+                first = event->tick;
+
+            last = event->tick;
+        }
+
+        state = event->value;
+    }
+
+    return edges < 2 ? 0 : (last - first) / (edges - 1);
+}
+
+static inline int sim_write_vcd(const char *filename)
+{
+    FILE *fp = fopen(filename, "w");
+    if (!fp)
+        return -1;
+
+    // each channel has a wire for the GPIO and a vector for the hardware PWM duty
+    fprintf(fp, "$timescale 1us $end\n$scope module ledz $end\n");
+    for (unsigned int i = 0; i < sim_channels_count; i++)
+    {
+        sim_channel_t *ch = &sim_channels[i];
+        fprintf(fp, "$var wire 1 %c p%d_%d $end\n", '!' + i * 2, ch->port, ch->pin);
+        fprintf(fp, "$var wire 16 %c p%d_%d_pwm $end\n", '!' + i * 2 + 1, ch->port, ch->pin);
+    }
+    fprintf(fp, "$upscope $end\n$enddefinitions $end\n");
+
+    fprintf(fp, "#0\n$dumpvars\n");
+    for (unsigned int i = 0; i < sim_channels_count; i++)
+        fprintf(fp, "0%c\nb0 %c\n", '!' + i * 2, '!' + i * 2 + 1);
+    fprintf(fp, "$end\n");
+
+    uint32_t tick = 0;
+    for (unsigned int i = 0; i < sim_events_count; i++)
+    {
+        sim_event_t *event = &sim_events[i];
+
+        if (event->tick != tick)
+        {
+            tick = event->tick;
+            fprintf(fp, "#%llu\n", (unsigned long long) SIM_US(tick));
+        }
+
+        char id = '!' + event->channel * 2;
+        if (event->kind == SIM_SET)
+        {
+            fprintf(fp, "%d%c\n", event->value, id);
+        }
+        else
+        {
+            fputc('b', fp);
+            for (int bit = 15; bit >= 0; bit--)
+                fputc('0' + ((event->value >> bit) & 1), fp);
+            fprintf(fp, " %c\n", id + 1);
+        }
+    }
+
+    fprintf(fp, "#%llu\n", (unsigned long long) SIM_US(sim_ticks));
+
+    return fclose(fp);
+}
+
+// binary trace: a header with the tick period in us and the amount of events followed
+// by the events, all fields are little endian
+// event: tick (32 bits), channel (8 bits), kind (8 bits), value (16 bits)
+static inline int sim_write_trace(const char *filename)
+{
+    FILE *fp = fopen(filename, "wb");
+    if (!fp)
+        return -1;
+
+    uint8_t buffer[8];
+    uint32_t header[2] = {LEDZ_TICK_PERIOD, sim_events_count};
+
+    for (int i = 0; i < 2; i++)
+    {
+        for (int j = 0; j < 4; j++)
+            buffer[j] = header[i] >> (j * 8);
+
+        fwrite(buffer, 1, 4, fp);
+    }
+
+    for (unsigned int i = 0; i < sim_events_count; i++)
+    {
+        sim_event_t *event = &sim_events[i];
+
+        for (int j = 0; j < 4; j++)
+            buffer[j] = event->tick >> (j * 8);
+
+        buffer[4] = event->channel;
+        buffer[5] = event->kind;
+        buffer[6] = event->value;
+        buffer[7] = event->value >> 8;
+
+        fwrite(buffer, 1, 8, fp);
+    }
+
+    return fclose(fp);
+}
+
+#endif
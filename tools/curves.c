@@ -0,0 +1,111 @@
+/*
+ * LEDZ - The LED Zeppelin
+ * https://github.com/ricardocrudo/ledz
+ *
+ * Generator of the perceptual brightness curves used by ledz.
+ *
+ * usage: curves [bits] > ledz_curves.h
+ *
+ * The tables of the legacy resolution are committed in src/ledz_curves.h, the
+ * library Makefile generates the others as ledz_curves_gen.h in its build
+ * directory, from the LEDZ_BRIGHTNESS_BITS of CONFIG.
+ *
+ * When bits is zero (default) the tables convert the brightness from 0 to 100
+ * into a duty cycle from 0 to 100, otherwise both ranges go from 0 to 2^bits - 1.
+ * Each table has a residual table with the rounding error of the duty cycle in
+ * 1/256 of a step, used by the dithering of the internal PWM.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+// gamma of the alternative curve
+#define GAMMA   2.2
+
+// CIE 1931 lightness to luminance, from: http://jared.geek.nz/2013/feb/linear-led-pwm
+static double cie1931(double lightness)
+{
+    double l = lightness * 100.0;
+
+    if (l <= 8.0)
+        return l / 902.3;
+
+    return pow((l + 16.0) / 116.0, 3.0);
+}
+
+static double gamma_curve(double lightness)
+{
+    return pow(lightness, GAMMA);
+}
+
+static void table(const char *name, double (*curve)(double), long max)
+{
+    printf("static const ledz_duty_t %s[%ld] = {", name, max + 1);
+
+    for (long i = 0; i <= max; i++)
+    {
+        if (i % 10 == 0)
+            printf("\n   ");
+
+        // rint rounds half to even, the same rounding of the original table
+        printf(" %*ld,", max > 255 ? 5 : 3, (long) rint(curve((double) i / max) * max));
+    }
+
+    printf("\n};\n");
+}
+
+static void residual_table(const char *name, double (*curve)(double), long max)
+{
+    printf("static const int8_t %s_residual[%ld] = {", name, max + 1);
+
+    for (long i = 0; i <= max; i++)
+    {
+        if (i % 10 == 0)
+            printf("\n   ");
+
+        double duty = curve((double) i / max) * max;
+        long residual = lrint((duty - rint(duty)) * 256.0);
+
+        // a residual of half step is only possible when rint rounds down
+        if (residual > 127)
+            residual = 127;
+
+        printf(" %4ld,", residual);
+    }
+
+    printf("\n};\n");
+}
+
+int main(int argc, char **argv)
+{
+    int bits = argc > 1 ? atoi(argv[1]) : 0;
+
+    if (bits != 0 && bits != 8 && bits != 12 && bits != 16)
+    {
+        fprintf(stderr, "bits must be 0 (legacy 0 to 100), 8, 12 or 16\n");
+        return 1;
+    }
+
+    long max = bits ? (1L << bits) - 1 : 100;
+
+    printf("// generated by tools/curves, do not edit\n");
+    printf("// the resolution is set by LEDZ_BRIGHTNESS_BITS (0 = legacy 0 to 100, 8, 12 or 16)\n");
+    printf("// the tables are static, so the header can be included by several sources\n\n");
+    printf("#define LEDZ_CURVES_BITS    %d\n\n", bits);
+
+    table("cie1931", cie1931, max);
+
+    printf("\n#ifdef LEDZ_CURVE_SUPPORT\n");
+    table("gamma22", gamma_curve, max);
+    printf("#endif\n");
+
+    printf("\n#ifdef LEDZ_DITHER_SUPPORT\n");
+    residual_table("cie1931", cie1931, max);
+
+    printf("\n#ifdef LEDZ_CURVE_SUPPORT\n");
+    residual_table("gamma22", gamma_curve, max);
+    printf("#endif\n#endif\n");
+
+    return 0;
+}